@@ -23,7 +23,11 @@ https://github.com/ruiseixasm/JsonMidiPlayer
 #include <list>
 #include <algorithm>
 #include <cmath>                // For std::round
+#include <cstdint>
+#include <cstring>              // For std::memchr
+#include <functional>           // For std::function
 #include <cstdlib>
+#include <sstream>              // For the device settings
 #include <thread>               // Include for std::this_thread::sleep_for
 #include <chrono>               // Include for std::chrono::seconds
 #include <nlohmann/json.hpp>    // Include the JSON library
@@ -31,7 +35,14 @@ https://github.com/ruiseixasm/JsonMidiPlayer
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <atomic>               // For the lock free PlayControl flags
+#include <mutex>
+#include <condition_variable>
+#include <future>               // For the ports opened in the background
+#include <bitset>
+#include <limits>
 #include <iomanip>              // For std::fixed and std::setprecision
+#include <random>               // For the sample of the delays
 
 #ifdef _WIN32
     #define NOMINMAX    // disables the definition of min and max macros.
@@ -39,6 +50,7 @@ https://github.com/ruiseixasm/JsonMidiPlayer
     #include <processthreadsapi.h> // For SetProcessInformation
 #else
     #include <pthread.h>
+    #include <sched.h>          // For the CPU affinity
     #include <time.h>
 #endif
 
@@ -47,6 +59,17 @@ https://github.com/ruiseixasm/JsonMidiPlayer
 #define FILE_URL  "https://github.com/ruiseixasm/JsonMidiPlayer"
 #define VERSION   "6.2.0"
 #define DRAG_DURATION_MS (1000.0/((120/60)*24))
+#define CONTROL_POLLING_US 10000    // Maximum sleep before the PlayControl flags are checked again
+#define CHECKPOINT_INTERVAL_MS 1000.0  // Time between the states kept by the seeking index
+#define STREAMING_RETENTION_MS 60000.0 // Streamed pins kept behind the playing position for seeking back
+#define DELAY_SAMPLES 65536         // Delays kept by device and class for the tail latencies, a sample above it
+#define SYSEX_CHUNK_BYTES 16        // Of the SysEx sent by chunks to the byte stream outputs, 5 ms on a DIN cable
+#define MIDI_DIN_BYTE_MS 0.32       // 10 bits at 31250 baud
+#define MAX_BURST_LEAD_MS 10.0      // Earliest a burst of messages is sent before its time on a slow port
+#define THINNING_TOLERANCE 1.0      // Default value deviation of the thinned curves, in 7 bit steps
+#define CATCH_UP_LOOKAHEAD 256      // Due pins looked at for a later value of the same controller
+#define OUTPUT_QUEUE_CAPACITY 4096  // Messages of each device waiting for its output worker
+#define OUTPUT_RETRY_US 1000        // Before flushing again a port that didn't take all the bytes
 
 
 // Taken from: https://users.cs.cf.ac.uk/Dave.Marshall/Multimedia/node158.html
@@ -73,6 +96,15 @@ const unsigned char system_clock_stop       = 0xFC; // Stop
 const unsigned char system_active_sensing   = 0xFE; // Active Sensing
 const unsigned char system_system_reset     = 0xFF; // System Reset
 
+// Message classes used to break down the delays by kind of midi message
+const unsigned char class_clock             = 0;    // Timing Clock
+const unsigned char class_note              = 1;    // Note On and Note Off
+const unsigned char class_control_change    = 2;    // Control Change
+const unsigned char class_pitch_bend        = 3;    // Pitch Bend
+const unsigned char class_sysex             = 4;    // SysEx (excluding MMC)
+const unsigned char class_transport         = 5;    // Start, Continue, Stop, Song Pointer and MMC
+const unsigned char class_other             = 6;    // Program Change, Pressures and the remaining
+const unsigned char total_message_classes   = 7;
 
 
 class MidiDevice;
@@ -87,6 +119,7 @@ private:
     std::vector<unsigned char> midi_message;  // Replaces midi_message[3]
     // Auxiliary variable for the final playing loop!!
     double delay_time_ms = -1;
+    double lead_time_ms = 0.0;      // Sent this earlier, like the bursts on the slow ports
 
 	// needed to recognize and already released Note !!
     size_t note_pressed_times = 1;   // BY DEFAULT THE NOTE ON IS 1 TIME PRESSED
@@ -119,6 +152,7 @@ public:
           midi_message(other.midi_message),           // Copy the midi_message vector
           priority(other.priority),                   // Copy the priority
           delay_time_ms(other.delay_time_ms),         // Copy the delay_time_ms
+          lead_time_ms(other.lead_time_ms),           // Copy the lead_time_ms
           note_pressed_times(other.note_pressed_times)          // Copy the note_released
     { }
 
@@ -130,7 +164,8 @@ public:
         return midi_device;
     }
 
-    void pluckTooth();
+    // late_ms lets the devices that place the messages at their exact time still do so
+    void pluckTooth(double late_ms = 0.0);
 
     void setDelayTime(double delay_time_ms) {
         this->delay_time_ms = delay_time_ms;
@@ -140,10 +175,24 @@ public:
         return this->delay_time_ms;
     }
 
+    void setLeadTime(double lead_time_ms) {
+        this->lead_time_ms = lead_time_ms;
+    }
+
+    double getLeadTime() const {
+        return this->lead_time_ms;
+    }
+
     std::vector<unsigned char> getMessage() const {
         return this->midi_message; // Returns a copy
     }
 
+    size_t getMessageSize() const {
+        return this->midi_message.size();
+    }
+
+    unsigned char getMessageClass() const;
+
     void setStatusByte(unsigned char status_byte) {
         this->midi_message[0] = status_byte;
     }
@@ -209,38 +258,128 @@ public:
 };
 
 
+// Output used by a device instead of its RtMidiOut, like the rawmidi and the JACK ones, whose devices
+// are only matched by the names starting with its prefix
+class DirectMidiOut {
+    public:
+        virtual ~DirectMidiOut() = default;
+        virtual const char *getNamePrefix() const = 0;
+        // Throws RtMidiError like the RtMidiOut ports
+        virtual void openPort() = 0;
+        virtual void closePort() = 0;
+        // late_ms is how late the message is sent, for the outputs that place it at its time
+        virtual void sendMessage(const unsigned char *midi_message, size_t message_size, double late_ms) = 0;
+        // For the outputs that keep the messages with the same time pending, never blocking
+        virtual bool flush() { return true; }
+        // Written as a midi byte stream, like to a DIN port, so a SysEx may be sent by chunks continuing
+        // each other, with Real-Time messages in between
+        virtual bool isByteStream() const { return false; }
+        // Time the port takes to send each byte, 0 when it takes the messages as fast as they are given
+        virtual double getByteTime() const { return 0.0; }
+};
+
+// Single producer and single consumer ring of the messages of a device, pushed by the playing once due
+// and written by the output worker of the device, so that a port that blocks only holds its own messages
+class OutputQueue {
+    public:
+        struct OutputMessage {
+            std::vector<unsigned char> midi_message;    // Empty to flush the messages before it
+            double late_ms = 0.0;
+            std::chrono::high_resolution_clock::time_point pushed_time;
+        };
+
+    private:
+        std::vector<OutputMessage> output_messages;     // Their vectors are reused, so pushing doesn't allocate
+        alignas(64) std::atomic<size_t> write_index{0}; // Written by the playing only
+        alignas(64) std::atomic<size_t> read_index{0};  // Written by the worker only
+        std::atomic<bool> closed_queue{false};
+        std::mutex waking_mutex;
+        std::condition_variable waking_condition;
+
+    public:
+        OutputQueue(size_t capacity = OUTPUT_QUEUE_CAPACITY) : output_messages(capacity) { }
+
+        // False when full, being the message dropped
+        bool push(const unsigned char *midi_message, size_t message_size, double late_ms);
+        // The oldest message, nullptr when empty
+        OutputMessage *front();
+        void pop();
+        void wake();
+        // Until woken or for timeout_us at most
+        void wait(long long timeout_us);
+        // The worker ends once it has written all the messages pushed before
+        void close();
+        bool isClosed() const;
+};
+
 class MidiDevice {
     private:
         RtMidiOut midiOut;
+        std::shared_ptr<DirectMidiOut> direct_out;  // Used instead of midiOut when set
         const std::string name;
         const unsigned int port;
         const bool verbose;
-        bool opened_port = false;
+        double byte_time_ms;                    // Of its port, 0 for no bandwidth limit
+        double thinning_interval_ms = 0.0;      // Between the messages of each controller, 0 for no thinning
+        double thinning_tolerance = THINNING_TOLERANCE;
+        double latency_ms = 0.0;                // Of its output, its whole stream is sent this earlier
+        std::atomic<bool> opened_port{false};   // Ports may be opened while other devices are playing
         bool unavailable_device = false;
+        // Set by the sent messages themselves
+        bool clock_running = false;
+        std::array<std::bitset<128>, 16> pressed_notes;
+        // A SysEx longer than SYSEX_CHUNK_BYTES is sent by chunks to a byte stream output, each one when the
+        // port is estimated to have sent the previous, so that a long dump doesn't hold the clock behind it
+        std::vector<unsigned char> sysex_chunks;
+        size_t sysex_sent_bytes = 0;
+        std::chrono::high_resolution_clock::time_point wire_free_time;  // When the port has sent all its bytes
+        // While the port is open its messages are written by its own worker, so that a port that blocks,
+        // like a sequencer client with a full buffer or an unplugged interface, never holds the other devices
+        std::unique_ptr<OutputQueue> output_queue;
+        std::thread output_worker;
+        bool queued_messages = false;           // Since the last flush
+        int output_cpu = -1;                    // Its worker is pinned to, negative for none
+        std::atomic<bool> *pinning_failed = nullptr;
     
     public:
-    
-        // Keeps MidiPin pointers by Channel_Pitch (uint16_t) (similar to byte_16)
-        std::unordered_map<uint16_t, MidiPin*>		channelpitch_last_pins_note_on;			// For Note On tracking
-        
-        // Keeps MidiPin dummy copies, thus NOT pointers of MidiPin
-        std::unordered_map<unsigned char, MidiPin>  statusbyte_last_pins_pitchbend;    		// For Pitch Bend and Aftertouch
-        std::unordered_map<uint16_t, MidiPin>       statusdatabyte_last_pin_controlchange;	// For Control Changeand Key Pressure
-
-        // Keeps MidiPin pointers
-        MidiPin *last_pin_clock = nullptr;          // Midi clock messages 0xF0
-        MidiPin *last_pin_song_pointer = nullptr;   // Midi clock messages 0xF2
-    
-    
+        struct ByteStreamReporting {
+            size_t fragmented_sysex = 0;
+            size_t sent_chunks      = 0;
+            // How long the clock messages wait on the port for the bytes before them
+            size_t total_clocks     = 0;
+            double total_clock_wire_delay   = 0.0;
+            double squared_clock_wire_delay = 0.0;
+            double maximum_clock_wire_delay = 0.0;
+        };
+        struct OutputReporting {
+            // From being pushed until being written by the worker, like when the port blocks
+            size_t total_messages       = 0;
+            double total_queue_delay    = 0.0;
+            double maximum_queue_delay  = 0.0;
+            size_t dropped_messages     = 0;    // Given to a full queue
+            size_t failed_messages      = 0;    // Whose writing threw an error
+        };
+
+    private:
+        ByteStreamReporting byte_stream_reporting;
+        OutputReporting output_reporting;
+        void writeMessage(const unsigned char *midi_message, size_t message_size, double late_ms);
+        void writeOutputQueue();
+
     public:
-        MidiDevice(std::string device_name, unsigned int device_port, bool verbose = false)
-                    : name(device_name), port(device_port), verbose(verbose) { }
+        MidiDevice(std::string device_name, unsigned int device_port, bool verbose = false,
+                    std::shared_ptr<DirectMidiOut> direct_out = nullptr)
+                    : direct_out(direct_out), name(device_name), port(device_port), verbose(verbose),
+                      byte_time_ms(direct_out ? direct_out->getByteTime() : 0.0) { }
         ~MidiDevice() { closePort(); }
     
         // Move constructor
         MidiDevice(MidiDevice &&other) noexcept : midiOut(std::move(other.midiOut)),
-                name(std::move(other.name)), port(other.port), verbose(other.verbose),
-                opened_port(other.opened_port) { }
+                direct_out(std::move(other.direct_out)), name(std::move(other.name)), port(other.port), verbose(other.verbose),
+                byte_time_ms(other.byte_time_ms), thinning_interval_ms(other.thinning_interval_ms),
+                thinning_tolerance(other.thinning_tolerance), latency_ms(other.latency_ms),
+                opened_port(other.opened_port.exchange(false)),     // Only moved before any worker is started
+                output_cpu(other.output_cpu), pinning_failed(other.pinning_failed) { }
     
         // Delete the copy constructor and copy assignment operator
         MidiDevice(const MidiDevice &) = delete;
@@ -250,7 +389,7 @@ class MidiDevice {
         MidiDevice &operator=(MidiDevice &&other) noexcept {
             if (this != &other) {
                 // Since name and port are const, they cannot be assigned.
-                opened_port = other.opened_port;
+                opened_port = other.opened_port.exchange(false);
                 // midiOut can't be assigned using the = assignment operator because has none.
                 // midiOut = std::move(other.midiOut);
             }
@@ -263,18 +402,387 @@ class MidiDevice {
         bool hasPortOpen() const;
         const std::string& getName() const;
         unsigned int getDevicePort() const;
-        void sendMessage(const std::vector<unsigned char> *midi_message);
+        void sendMessage(const std::vector<unsigned char> *midi_message, double late_ms = 0.0);
+        // Writes the messages the direct outputs keep pending, being the others sent right away
+        void flushMessages();
+        // Empty for the RtMidiOut devices
+        const char *getNamePrefix() const;
+        bool isByteStream() const;
+        // The sequencer ports have no limit by default, given that they may be software synths
+        void setByteTime(double byte_time_ms);
+        double getByteTime() const;
+        // The Control Change, Pitch Bend and Channel Pressure curves are thinned down to this rate, 0 for none
+        void setThinning(double messages_per_second, double value_tolerance = THINNING_TOLERANCE);
+        double getThinningInterval() const;
+        double getThinningTolerance() const;
+        // From sending a message to it being played, like the buffer of a software synth or a slow interface
+        void setLatency(double latency_ms);
+        double getLatency() const;
+        bool hasSysExChunks() const;
+        std::chrono::high_resolution_clock::time_point getChunkTime() const;
+        void sendSysExChunk();
+        // Sends the chunks left at once, like before any message that isn't Real-Time
+        void finishSysEx();
+        const ByteStreamReporting &getByteStreamReporting() const;
+        // Set before its port is opened, the CPU its worker is pinned to and the flag raised if it can't be
+        void setOutputCpu(int output_cpu, std::atomic<bool> *pinning_failed = nullptr);
+        // Waits for its worker to write all the queued messages, being the next ones written right away
+        void drainOutput();
+        // Only complete once drained
+        const OutputReporting &getOutputReporting() const;
+        bool isClockRunning() const;
+        bool stopClock();
+        void releaseNotes();
     };
+
+
+const uint32_t no_device_id = 0xFFFFFFFF;
+
+// Built once per playing session over the available devices, being their positions the stable device ids,
+// each distinct name is matched against the devices names only the first time it's given
+class MidiDeviceResolver {
+    private:
+        std::vector<MidiDevice> &available_midi_devices;
+        struct DeviceName {
+            std::vector<uint32_t> matching_devices;     // Whose names contain it, in their order
+            uint32_t connected_device = no_device_id;
+        };
+        std::unordered_map<std::string, uint32_t> name_ids;
+        std::vector<DeviceName> device_names;           // By their name id
+        const bool verbose;
+
+        // The discovery thread enumerates the devices and opens the requested ports while the input is parsed
+        std::thread discovery_thread;
+        std::mutex requests_mutex;
+        std::condition_variable requests_condition;
+        std::vector<std::pair<std::vector<std::string>, bool>> requested_names;
+        bool discovery_finishing = false;
+        int discovery_result = 0;
+        std::vector<std::future<void>> port_openings;   // By device id, valid while opened in the background
+        int output_cpu = -1;
+        std::atomic<bool> *pinning_failed = nullptr;
+
+        void discoverDevices();
+        void openRequestedPorts(const std::vector<std::string> &device_names, bool all_devices);
+
+    public:
+        MidiDeviceResolver(std::vector<MidiDevice> &available_midi_devices, bool verbose = false);
+        ~MidiDeviceResolver();
+
+        // Set before the discovery, the CPU the output workers of all devices are pinned to
+        void setOutputCpu(int output_cpu, std::atomic<bool> *pinning_failed = nullptr);
+        // The devices are only added by the discovery, with the ports of the requested names opened concurrently
+        void startDiscovery();
+        // Waits for the devices enumeration, 0 when there are devices to connect
+        int finishDiscovery();
+        // Never blocks, only the first port the names would connect to is opened ahead, unless all_devices,
+        // like for the clocks, in which case all the matching ports are
+        void requestNames(const std::vector<std::string> &device_names, bool all_devices = false);
+
+        uint32_t getNameId(const std::string &device_name);
+        const std::vector<uint32_t> &getMatchingDevices(uint32_t name_id) const;
+        // The first matching device whose port opens, no_device_id if none does
+        uint32_t connectName(uint32_t name_id);
+        // Waits for the port being opened in the background, if it is
+        bool openDevice(uint32_t device_id);
+        // Waits for all the ports still being opened in the background
+        void waitOpenings();
+        // The device of the first name that connects, like in the json "devices" lists
+        uint32_t connectNames(const std::vector<std::string> &device_names);
+        // nullptr for no_device_id
+        MidiDevice *getDevice(uint32_t device_id);
+};
+
+
+// Last pins of a device kept by the clean up pass
+struct MidiTracking {
+    // Keeps MidiPin pointers by Channel_Pitch (uint16_t) (similar to byte_16)
+    std::unordered_map<uint16_t, MidiPin*>		channelpitch_last_pins_note_on;			// For Note On tracking
     
+    // Keeps MidiPin dummy copies, thus NOT pointers of MidiPin
+    std::unordered_map<unsigned char, MidiPin>  statusbyte_last_pins_pitchbend;    		// For Pitch Bend and Aftertouch
+    std::unordered_map<uint16_t, MidiPin>       statusdatabyte_last_pin_controlchange;	// For Control Changeand Key Pressure
+
+    // Keeps MidiPin pointers
+    MidiPin *last_pin_clock = nullptr;          // Midi clock messages 0xF0
+    MidiPin *last_pin_song_pointer = nullptr;   // Midi clock messages 0xF2
+};
+    
+
+// Channel state of a device at a given time, needed to chase it when seeking
+class MidiState {
+    private:
+        std::array<std::array<signed char, 128>, 16> control_change;    // -1 while never set
+        std::array<signed char, 16> program_change;
+        std::array<signed char, 16> channel_pressure;
+        std::array<short, 16> pitch_bend;                               // 14 bits (LSB | MSB << 7)
+        std::array<std::array<unsigned char, 128>, 16> note_velocity;   // 0 for released notes
+        bool clock_running = false;
+        unsigned int clock_pulses = 0;                                  // Since the last clock Start
+
+    public:
+        MidiState();
+
+        void updateState(const MidiPin &midi_pin);
+        // Appends to chase_pins the messages that put the device in this state
+        void chaseState(MidiDevice *midi_device, double time_ms, std::vector<MidiPin> &chase_pins) const;
+        // Appends to release_pins the Note Offs of the pressed notes and the clock Stop if running
+        void releaseState(MidiDevice *midi_device, double time_ms, std::vector<MidiPin> &release_pins) const;
+};
+
+
+// Devices states right before the first pin at or after time_ms
+struct MidiCheckpoint {
+    double time_ms;
+    std::list<MidiPin>::iterator first_pin;
+    std::unordered_map<MidiDevice*, MidiState> device_states;
+};
+
+std::vector<MidiCheckpoint> buildCheckpoints(std::list<MidiPin> &midi_pins);
+std::list<MidiPin>::iterator seekMidiStates(std::list<MidiPin> &midi_pins, const std::vector<MidiCheckpoint> &checkpoints,
+                                            double seek_ms, std::unordered_map<MidiDevice*, MidiState> &device_states);
+std::list<MidiPin>::iterator seekMidiPins(std::list<MidiPin> &midi_pins, const std::vector<MidiCheckpoint> &checkpoints,
+                                            double seek_ms, std::vector<MidiPin> &chase_pins);
+void trimMidiPins(std::list<MidiPin> &midi_pins, std::vector<MidiCheckpoint> &checkpoints, double keep_ms);
+
+
+// Piecewise linear mapping of the timeline time into the playing time, each segment with its own rate
+class TempoMap {
+    private:
+        struct TempoSegment {
+            double timeline_ms;
+            double playing_ms;
+            double playing_rate;
+        };
+        std::vector<TempoSegment> tempo_segments;
+
+    public:
+        TempoMap(double playing_rate = 1.0);
+
+        // Restarts the mapping with timeline_ms played at playing_ms
+        void resetTempo(double timeline_ms, double playing_ms);
+        // From timeline_ms onwards the timeline is played at the new rate
+        void setPlayingRate(double timeline_ms, double playing_rate);
+        double getPlayingRate() const;
+        double getPlayingTime(double timeline_ms) const;
+        double getTimelineTime(double playing_ms) const;
+};
+
+
+struct ShmRingHeader;   // Shared memory events ring, see JsonMidiPlayer_shm.hpp
+
+// Where the appended fragment times start from
+const unsigned char fragment_at_start   = 0;    // The start of the playing
+const unsigned char fragment_at_now     = 1;    // The current timeline time
+const unsigned char fragment_at_end     = 2;    // The end of the fragments appended before
+
+// Formats of the input documents, all with the same schema
+const unsigned char format_detect   = 0;    // From its first bytes
+const unsigned char format_json     = 1;
+const unsigned char format_cbor     = 2;
+const unsigned char format_msgpack  = 3;
+
+// What the playing does when it falls behind
+const unsigned char late_policy_drag     = 0;   // Shifts the rest of the timeline by the drag, keeping the time between the pins
+const unsigned char late_policy_catch_up = 1;   // Skips the automation a later due pin supersedes, without any drag
+
+struct JsonFile;
+struct MidiEventRecord;
+struct MidiEventsData;
+
+// Appended fragment, kept in a lock free stack until processed
+struct StreamFragment {
+    std::string json_str;           // Or its CBOR or MessagePack bytes
+    double offset_ms = 0.0;         // Added to the fragment times
+    unsigned char fragment_at = fragment_at_start;
+    std::chrono::steady_clock::time_point appended_at;
+    StreamFragment *next = nullptr;
+    bool files_read = false;        // Appended already read into json_files, instead of json_str
+    std::vector<JsonFile> json_files;
+    bool events_read = false;       // Appended as binary events instead, with the names and the SysEx they refer to
+    std::vector<MidiEventRecord> events;
+    std::vector<std::string> device_names;  // Empty for none
+    std::vector<unsigned char> sysex_data;
+
+    // Appended now, being its content set afterwards
+    StreamFragment(double offset_ms, unsigned char fragment_at);
+};
+
+// Applied to the devices whose names contain device_name
+struct DeviceSetting {
+    std::string device_name;
+    double value;
+};
+
+// Comma separated device names each with its value, like "Blofeld=31.25,FLUID=0"
+std::vector<DeviceSetting> readDeviceSettings(const char* device_settings);
+
+// Lock free flags shared between the calling thread and the playing thread
+class PlayControl {
+    private:
+        std::atomic<StreamFragment*> stream_fragments{nullptr};    // Most recent first
+        void pushFragment(StreamFragment *fragment);
+    public:
+        std::atomic<bool> stop_playing{false};
+        std::atomic<bool> pause_playing{false};
+        std::atomic<bool> finished_playing{false};
+        std::atomic<double> seek_ms{-1.0};      // Set before playing it's the start time, negative when none
+        std::atomic<double> loop_start_ms{0.0};
+        std::atomic<double> loop_end_ms{-1.0};  // Looping is disabled while not after loop_start_ms
+        std::atomic<double> playing_rate{1.0};  // 0.5 plays at half speed and 2.0 at double speed
+        // Negative overlays all files, otherwise each file plays after the previous one with this gap
+        std::atomic<double> sequential_gap_ms{-1.0};
+        std::atomic<double> played_ms{0.0};     // Time of the last plucked pin
+        std::atomic<double> duration_ms{0.0};   // Time of the last pin, set once processed
+        // While true the playing waits for appended fragments, closing it lets the playing finish
+        std::atomic<bool> streaming_input{false};
+        std::atomic<double> timeline_ms{0.0};   // Current timeline time while streaming
+        std::atomic<size_t> late_pins{0};       // Streamed pins that arrived after their time
+        std::atomic<double> first_pin_latency_ms{-1.0};  // Of the last fragment, from appended to played
+        std::atomic<size_t> flushed_playing{0}; // Times the pins still to be played were dropped, see flushPlaying
+        ShmRingHeader *shm_ring = nullptr;      // Set before streaming, its events are played like fragments
+        const char *export_smf = nullptr;       // Set before playing, the timeline is written to this file instead
+        // Set before playing, the port rates in kbaud, like 31.25 for a DIN cable, or 0 for no limit
+        std::vector<DeviceSetting> device_bandwidths;
+        // Set before playing, the maximum messages per second of each controller, or 0 to keep them all
+        std::vector<DeviceSetting> device_thinning;
+        double thinning_tolerance = THINNING_TOLERANCE;
+        // Set before playing, the output latency of each device in milliseconds, compensated by sending it earlier
+        std::vector<DeviceSetting> device_latencies;
+        unsigned char late_policy = late_policy_drag;   // Set before playing
+        // Set before playing, the CPU the playing thread and the output workers are pinned to, negative for none
+        int playing_cpu = -1;
+        std::atomic<bool> pinning_failed{false};    // Some of them couldn't be pinned to the playing_cpu
+
+        ~PlayControl();
+
+        // Never blocks, the fragment is only parsed and merged by the playing in the background
+        void appendFragment(const char* json_str, double offset_ms = 0.0, unsigned char fragment_at = fragment_at_start);
+        // Same for json, CBOR or MessagePack, detected from its first bytes
+        void appendFragment(const unsigned char* input_data, size_t input_size,
+                                double offset_ms = 0.0, unsigned char fragment_at = fragment_at_start);
+        // Same for the files already read by readJsonFiles, so that they aren't parsed twice
+        void appendFragment(std::vector<JsonFile> &&json_files,
+                                double offset_ms = 0.0, unsigned char fragment_at = fragment_at_start);
+        // Same for binary events, copied so that the caller's arrays may be freed right away
+        void appendFragment(const MidiEventsData &events_data,
+                                double offset_ms = 0.0, unsigned char fragment_at = fragment_at_start);
+        // Drops the fragments not yet processed and the pins still to be played, releasing their notes,
+        // while the streaming goes on with the devices kept open
+        void flushPlaying();
+        // Takes all appended fragments at once, the oldest first
+        StreamFragment *takeFragments();
+        bool hasFragments() const {
+            return stream_fragments.load() != nullptr;
+        }
+};
 
     
 
 // Declare the function in the header file
 void disableBackgroundThrottling();
 
+struct PlayReporting {
+    size_t json_processing  = 0;    // milliseconds
+    size_t total_generated  = 0;
+    size_t total_validated  = 0;
+    size_t total_incorrect  = 0;
+    size_t total_redundant  = 0;
+    size_t total_thinned    = 0;    // Removed from the dense automation curves
+    double total_drag       = 0.0;
+    double total_delay      = 0.0;
+    double maximum_delay    = 0.0;
+    double minimum_delay    = 0.0;
+    double average_delay    = 0.0;
+    double sd_delay         = 0.0;
+    size_t total_late       = 0;    // Streamed pins that arrived after their time
+    double total_lateness   = 0.0;
+    double maximum_lateness = 0.0;
+    size_t total_fragments  = 0;    // Streamed fragments with pins
+    double total_first_pin_latency   = 0.0;
+    double maximum_first_pin_latency = 0.0;
+    size_t total_fragmented_sysex    = 0;    // Sent by chunks to the byte stream outputs
+    size_t total_sysex_chunks        = 0;
+    size_t total_superseded = 0;    // Automation skipped while catching up
+    size_t total_saturated  = 0;    // Bursts whose port couldn't send them by their time
+    double maximum_saturation = 0.0;
+};
+
+// Binary input event, 16 bytes that map directly onto numpy structured arrays or ctypes arrays
+struct MidiEventRecord {
+    double time_ms;             //  0
+    uint8_t device;             //  8 index in the device names
+    uint8_t status_byte;        //  9
+    uint8_t data_byte_1;        // 10
+    uint8_t data_byte_2;        // 11
+    uint32_t sysex_offset;      // 12 where a SysEx message starts in the SysEx data, from its F0 up to its F7
+};
+static_assert(sizeof(MidiEventRecord) == 16, "MidiEventRecord shall be 16 bytes");
+
+// Document read from a file, with a single Json Midi Player file or a list of them
+struct InputDocument {
+    std::string input_data;
+    unsigned char input_format = format_detect;
+};
+
+// Binary input, the events with the device names they refer to and the bytes of their SysEx messages
+struct MidiEventsData {
+    const MidiEventRecord *events = nullptr;
+    size_t total_events = 0;
+    const char* const* device_names = nullptr;  // Matched like the json "devices" lists
+    size_t total_devices = 0;
+    const unsigned char *sysex_data = nullptr;
+    size_t sysex_size = 0;
+};
+
+// By the extension of the filename when given, otherwise by its first bytes, format_detect when ambiguous
+unsigned char getInputFormat(const unsigned char* input_data, size_t input_size, const char* filename = nullptr);
+// Throws a nlohmann::json::exception when not valid, the ambiguous binary ones are tried as CBOR and then as MessagePack
+nlohmann::json parseInputData(const unsigned char* input_data, size_t input_size, unsigned char input_format = format_detect);
+// Json "clock" item, pulsing the clocked devices and starting and stopping the controlled ones with MMC
+struct JsonClock {
+    unsigned int total_clock_pulses = 0;
+    unsigned int pulse_duration_min_numerator = 0;
+    unsigned int pulse_duration_min_denominator = 0;
+    std::vector<std::string> clocked_devices;
+    std::vector<std::string> controlled_devices;
+};
+void addClockPins(const JsonClock &json_clock, MidiDeviceResolver &device_resolver,
+                    std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, double offset_ms = 0.0);
+// Same messages as the ones accepted from json, with the right number of data bytes
+bool isValidMidiMessage(const unsigned char *midi_message, size_t size);
+// Sorting priority of a message at the same time, 0x00 for a message that isn't valid
+unsigned char getMessagePriority(const std::vector<unsigned char> &midi_message);
+unsigned char getMessagePriority(const unsigned char *midi_message, size_t size);
+// Adds the pins of a single Json Midi Player file, with its times shifted by offset_ms
+void processJsonData(nlohmann::json &jsonData, MidiDeviceResolver &device_resolver,
+                        std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, bool verbose, double offset_ms = 0.0);
+// Sorts and cleans up the redundant pins, releasing the notes and stopping the clocks at the end
+void processMidiPins(std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting);
+// Drops the automation messages over the thinning rate of their devices, keeping the ends and the turns of the curves
+void thinAutomation(std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting);
+// Leads the pins of the devices with latency by it, and the bursts of the devices with a limited bandwidth
+// so that they are centered on their time
+void scheduleBursts(std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting);
+// Adds the pins of the binary input events, with their times shifted by offset_ms
+void processMidiEvents(const MidiEventsData &events_data, MidiDeviceResolver &device_resolver,
+                        std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, double offset_ms = 0.0);
+
 void setRealTimeScheduling();
+void setNormalScheduling();
+// Pins the calling thread to a single CPU, false when it can't be
+bool setThreadAffinity(int cpu);
+// The highest CPU the process may run on
+int getLastCpu();
 void highResolutionSleep(long long microseconds);
-int PlayList(const char* json_str, bool verbose = false);
+int PlayList(const char* json_str, bool verbose = false, PlayControl *play_control = nullptr);
+// Same as PlayList but without any json, for large sequences
+int PlayEvents(const MidiEventsData &events_data, bool verbose = false, PlayControl *play_control = nullptr);
+// Json, CBOR or MessagePack list of files, the format detected from its first bytes
+int PlayData(const unsigned char* input_data, size_t input_size, bool verbose = false, PlayControl *play_control = nullptr);
+// The documents of each file played together with the binary input events, if any
+int PlayInput(const std::vector<InputDocument> &input_documents, const MidiEventsData *events_data,
+                bool verbose = false, PlayControl *play_control = nullptr);
 
 
 #endif // MIDI_JSON_PLAYER_HPP
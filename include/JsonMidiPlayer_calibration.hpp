@@ -0,0 +1,45 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#ifndef MIDI_JSON_PLAYER_CALIBRATION_HPP
+#define MIDI_JSON_PLAYER_CALIBRATION_HPP
+
+#include "JsonMidiPlayer.hpp"
+
+#define CALIBRATION_PROBES 16           // Round trips measured, being the median the one taken
+#define CALIBRATION_TIMEOUT_MS 500.0    // After which a probe is taken as lost
+#define CALIBRATION_INTERVAL_MS 50.0    // Between the probes, so that each one finds the ports idle
+
+// Each probe is a non commercial SysEx with its index, so that it never plays anything on the way
+struct RoundTripReporting {
+    std::string output_port;            // The ports matched by the given names
+    std::string input_port;
+    size_t total_probes     = 0;
+    size_t total_returned   = 0;
+    double minimum_ms       = 0.0;
+    double median_ms        = 0.0;
+    double maximum_ms       = 0.0;
+};
+
+// Times the probes sent on the first output port whose name contains output_name until they come back on
+// the first input port whose name contains input_name, like a cable from a Midi Out to a Midi In or a
+// through port, false when there are no such ports
+bool measureRoundTrip(const std::string &output_name, const std::string &input_name,
+                        RoundTripReporting &round_trip, size_t total_probes = CALIBRATION_PROBES);
+
+// Prints the round trip through the loopback given as "output_name,input_name" and the latency to set
+int CalibrateLatency(const char* loopback_ports, bool verbose = false);
+
+#endif // MIDI_JSON_PLAYER_CALIBRATION_HPP
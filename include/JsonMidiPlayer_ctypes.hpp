@@ -27,6 +27,42 @@ https://github.com/ruiseixasm/JsonMidiPlayer
 
 extern "C" {    // Needed for Python ctypes
     DLL_EXPORT int PlayList_ctypes(const char* json_str, int verbose);
+    // Non blocking playing, the returned handle is released by PlayList_wait_ctypes
+    DLL_EXPORT void* PlayList_start_ctypes(const char* json_str, int verbose);
+    // Json, CBOR or MessagePack bytes, the format detected from the first ones
+    DLL_EXPORT int PlayList_data_ctypes(const unsigned char* input_data, size_t input_size, int verbose);
+    DLL_EXPORT void* PlayList_data_start_ctypes(const unsigned char* input_data, size_t input_size, int verbose);
+    // Keeps playing the appended fragments, with their times given from the start, until closed
+    DLL_EXPORT void* PlayList_stream_ctypes(const char* json_str, int verbose);
+    // Plays the events written in the named shared memory ring, nullptr if it can't be created
+    DLL_EXPORT void* PlayList_ring_ctypes(const char* shm_name, int verbose);
+    // Plays an array of MidiEventRecord without any json, device_names being indexed by each event device,
+    // failing when device_names is null while total_devices isn't zero
+    DLL_EXPORT int PlayList_events_ctypes(const MidiEventRecord* events, size_t total_events,
+                                            const char** device_names, size_t total_devices,
+                                            const unsigned char* sysex_data, size_t sysex_size, int verbose);
+    // Non blocking, the arrays are copied so they may be freed once it returns, nullptr for null device_names
+    DLL_EXPORT void* PlayList_events_start_ctypes(const MidiEventRecord* events, size_t total_events,
+                                            const char** device_names, size_t total_devices,
+                                            const unsigned char* sysex_data, size_t sysex_size, int verbose);
+    // Plays a Standard MIDI File, with the comma separated devices of its tracks, the last one for the remaining
+    DLL_EXPORT int PlayList_smf_ctypes(const char* filename, const char* track_devices, int verbose);
+    DLL_EXPORT void* PlayList_smf_start_ctypes(const char* filename, const char* track_devices, int verbose);
+    DLL_EXPORT void PlayList_append_ctypes(void* play_handle, const char* json_str);
+    DLL_EXPORT void PlayList_append_data_ctypes(void* play_handle, const unsigned char* input_data, size_t input_size);
+    DLL_EXPORT void PlayList_close_ctypes(void* play_handle);
+    DLL_EXPORT double PlayList_timeline_ctypes(void* play_handle);
+    DLL_EXPORT size_t PlayList_late_ctypes(void* play_handle);
+    DLL_EXPORT void PlayList_stop_ctypes(void* play_handle);
+    DLL_EXPORT void PlayList_pause_ctypes(void* play_handle);
+    DLL_EXPORT void PlayList_resume_ctypes(void* play_handle);
+    DLL_EXPORT void PlayList_seek_ctypes(void* play_handle, double time_ms);
+    DLL_EXPORT void PlayList_loop_ctypes(void* play_handle, double start_ms, double end_ms);
+    DLL_EXPORT void PlayList_rate_ctypes(void* play_handle, double playing_rate);
+    DLL_EXPORT double PlayList_progress_ctypes(void* play_handle);
+    DLL_EXPORT double PlayList_duration_ctypes(void* play_handle);
+    DLL_EXPORT int PlayList_playing_ctypes(void* play_handle);
+    DLL_EXPORT int PlayList_wait_ctypes(void* play_handle);
     DLL_EXPORT int add_ctypes(int a, int b);
 }
 
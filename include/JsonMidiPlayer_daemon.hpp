@@ -0,0 +1,49 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#ifndef MIDI_JSON_PLAYER_DAEMON_HPP
+#define MIDI_JSON_PLAYER_DAEMON_HPP
+
+#include "JsonMidiPlayer.hpp"
+
+#define DAEMON_PREFAULT_BYTES (256 * 1024)  // Stack touched by the playing thread before it starts
+#define DAEMON_MAXIMUM_REQUEST_BYTES (16 * 1024 * 1024)    // Above it the request is refused unread
+#define DAEMON_RECEIVE_TIMEOUT_MS 2000      // For the whole request, so that a stalled client can't hold the daemon
+#define DAEMON_MAXIMUM_AHEAD_MS 600000.0    // Submissions are refused while the ones queued go further than this
+#define DAEMON_EVENTS_MAGIC 0x45504D4A      // "JMPE" in little endian, the bytes 4A 4D 50 45
+
+// Payload of the binary events submissions, in the native byte order like the MidiEventRecord, followed by
+// total_events records, then total_devices device names each one ended by a zero byte, and then sysex_size
+// bytes of SysEx data, the records pointing into it
+struct DaemonEventsHeader {
+    uint32_t magic;                     // DAEMON_EVENTS_MAGIC
+    uint32_t total_events;
+    uint32_t total_devices;
+    uint32_t sysex_size;
+};
+static_assert(sizeof(DaemonEventsHeader) == 16, "DaemonEventsHeader shall be 16 bytes");
+
+// One request per connection, the client writes it and then shuts down its writing side:
+//     PLAY [offset_ms]\n<json>     plays the json files from now on, plus the offset
+//     QUEUE [gap_ms]\n<json>       plays the json files after the ones submitted before, plus the gap
+//     PLAY_EVENTS [offset_ms]\n<events>, QUEUE_EVENTS [gap_ms]\n<events>  same for the binary events
+//     STATUS\n                     answers with a json object of the playing state
+//     STOP\n                       drops what is still to be played, releasing all notes, keeping the devices open
+//     QUIT\n                       stops the playing and the daemon
+// Each request is answered with a single line, either "OK", the status json or "ERROR <reason>".
+// The playing thread and the output workers are pinned to playing_cpu, or to the last CPU when negative
+int PlayDaemon(const char* socket_path, bool verbose = false, int playing_cpu = -1);
+
+#endif // MIDI_JSON_PLAYER_DAEMON_HPP
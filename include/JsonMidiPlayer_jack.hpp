@@ -0,0 +1,61 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#ifndef MIDI_JSON_PLAYER_JACK_HPP
+#define MIDI_JSON_PLAYER_JACK_HPP
+
+#include <cstdint>
+#include "JsonMidiPlayer.hpp"
+
+// The JACK output is built when the jack library is found, unless -DJSON_MIDI_PLAYER_JACK=OFF
+
+// Only the device names starting with it are matched against the JACK ports, like "jack:fluidsynth"
+#define JACK_PREFIX "jack:"
+#define JACK_RINGBUFFER_BYTES 65536     // Of each device, for the messages sent but not yet placed
+
+struct JackMidiPort {
+    std::string name;               // With the prefix
+    std::string port_name;          // The JACK port connected to, like "fluidsynth:midi_00"
+};
+
+// The midi input ports of the running JACK server, none if there is none or if not built
+std::vector<JackMidiPort> getJackMidiPorts();
+
+// Places each message at the exact frame of its time, always one period after it's sent,
+// instead of at the start of the next period
+class JackMidiOut : public DirectMidiOut {
+    public:
+        struct JackOutputData;              // Kept out of this header with the JACK types
+
+    private:
+        const std::string port_name;
+        JackOutputData *jack_data = nullptr;
+        std::vector<char> event_buffer;     // Header and bytes written to the ringbuffer at once
+
+    public:
+        JackMidiOut(const std::string &port_name);
+        ~JackMidiOut();
+
+        JackMidiOut(const JackMidiOut &) = delete;
+        JackMidiOut &operator=(const JackMidiOut &) = delete;
+
+        const char *getNamePrefix() const override;
+        void openPort() override;
+        // Waits for the messages still in the ringbuffer, up to a second
+        void closePort() override;
+        void sendMessage(const unsigned char *midi_message, size_t message_size, double late_ms) override;
+};
+
+#endif // MIDI_JSON_PLAYER_JACK_HPP
@@ -0,0 +1,68 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#ifndef MIDI_JSON_PLAYER_PARSER_HPP
+#define MIDI_JSON_PLAYER_PARSER_HPP
+
+#include <cstdint>
+#include "JsonMidiPlayer.hpp"
+
+// Rejected items with a "devices" list are only counted as incorrect when the list connects a device
+const uint32_t rejected_rows_item       = 0xFFFFFFFF;  // Counted even without a device, if the file has the rows encoding
+const uint32_t rejected_never_counted   = 0xFFFFFFFE;  // Like the clocks, or the messages before any "devices" list
+
+// Midi message of a json item, the SysEx ones kept in the SysEx data of its file
+struct JsonEventRecord {
+    double time_ms;
+    uint32_t devices_index;         // Of its "devices" list, or of the header ones for the rows
+    uint32_t message_size;          // Up to 3 bytes kept in midi_message, otherwise the SysEx data from sysex_offset
+    uint32_t sysex_offset;
+    unsigned char midi_message[3];
+    unsigned char priority;
+};
+
+struct JsonRejectedItem {
+    size_t byte_offset;             // Where the item starts in the document
+    uint32_t devices_index;
+    const char *reason;
+};
+
+// A Json Midi Player file read straight into its events, or by nlohmann for the unusual documents
+struct JsonFile {
+    nlohmann::json json_data;       // Only set when read by nlohmann, processed then by processJsonData
+    bool file_type = false;         // With the right "filetype" and "url"
+    bool has_content = false;       // With a non empty "content" list
+    bool has_encoding = false;
+    std::string encoding;
+    std::vector<std::vector<std::string>> devices_lists;   // Each distinct one only once
+    std::vector<JsonEventRecord> events;
+    std::vector<JsonClock> clocks;
+    std::vector<std::vector<std::string>> rows_devices_lists;  // The header "devices" of the rows encoding
+    std::vector<JsonEventRecord> rows_events;
+    std::vector<unsigned char> sysex_data;
+    std::vector<JsonRejectedItem> rejected_items;
+};
+
+// A json text is read in a single pass by the schema parser, falling back to nlohmann when it's an unusual one,
+// like the CBOR and MessagePack ones, throwing a nlohmann::json::exception when not valid
+// The device names read are requested to the device_resolver, if given, so that their ports open while parsing
+std::vector<JsonFile> readJsonFiles(const unsigned char* input_data, size_t input_size,
+                                        unsigned char input_format = format_detect, bool verbose = false,
+                                        MidiDeviceResolver *device_resolver = nullptr);
+// Adds the pins of a single file, with its times shifted by offset_ms
+void processJsonFile(JsonFile &json_file, MidiDeviceResolver &device_resolver,
+                        std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, bool verbose, double offset_ms = 0.0);
+
+#endif // MIDI_JSON_PLAYER_PARSER_HPP
@@ -0,0 +1,68 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#ifndef MIDI_JSON_PLAYER_RAWMIDI_HPP
+#define MIDI_JSON_PLAYER_RAWMIDI_HPP
+
+#include <cstdint>
+#include "JsonMidiPlayer.hpp"
+
+// The ALSA rawmidi output is only built on Linux with -DJSON_MIDI_PLAYER_RAWMIDI=ON
+typedef struct _snd_rawmidi snd_rawmidi_t;
+
+// Only the device names starting with it are matched against the rawmidi devices, so that the same
+// hardware interface isn't matched twice, like "rawmidi:Blofeld" for "rawmidi:Blofeld MIDI 1 hw:1,0,0"
+#define RAWMIDI_PREFIX "rawmidi:"
+
+struct RawMidiPort {
+    std::string name;               // With the prefix and ending with its hw id
+    std::string hw_id;              // Like "hw:1,0,0"
+};
+
+// The output rawmidi subdevices of all the cards, none if not built
+std::vector<RawMidiPort> getRawMidiPorts();
+
+// Writes the midi messages as raw bytes straight to the hardware port, bypassing the sequencer
+class RawMidiOut : public DirectMidiOut {
+    private:
+        const std::string hw_id;
+        const bool running_status;          // Leaves out the status bytes repeated by the channel messages
+        snd_rawmidi_t *rawmidi_handle = nullptr;
+        unsigned char last_status = 0;      // 0 when the next channel message has to send its status
+        // The messages with the same time are written together, and what the port can't take is kept for the next flush
+        std::vector<unsigned char> pending_bytes;
+        size_t written_bytes = 0;
+
+    public:
+        RawMidiOut(const std::string &hw_id, bool running_status = true);
+        ~RawMidiOut();
+
+        RawMidiOut(const RawMidiOut &) = delete;
+        RawMidiOut &operator=(const RawMidiOut &) = delete;
+
+        const char *getNamePrefix() const override;
+        void openPort() override;
+        // Writes all the pending bytes first, blocking until the port drains them
+        void closePort() override;
+        // Kept pending until flushed, being written as soon as possible
+        void sendMessage(const unsigned char *midi_message, size_t message_size, double late_ms = 0.0) override;
+        // Never blocks, true when no bytes are left pending
+        bool flush() override;
+        bool isByteStream() const override;
+        double getByteTime() const override;
+        bool hasPendingBytes() const;
+};
+
+#endif // MIDI_JSON_PLAYER_RAWMIDI_HPP
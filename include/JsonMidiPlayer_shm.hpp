@@ -0,0 +1,91 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#ifndef MIDI_JSON_PLAYER_SHM_HPP
+#define MIDI_JSON_PLAYER_SHM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "JsonMidiPlayer.hpp"
+
+#define SHM_RING_MAGIC 0x52504D4A      // "JMPR" in little endian, the bytes 4A 4D 50 52
+#define SHM_RING_VERSION 1
+#define SHM_RING_CAPACITY 4096          // Events, always a power of 2
+#define SHM_DEVICE_NAMES 16
+#define SHM_DEVICE_NAME_SIZE 64         // Null terminated
+#define SHM_MESSAGE_SIZE 22             // Longer SysEx messages shall be given as json
+
+// Shared memory layout, all fields in the host byte order (little endian on x86 and ARM):
+//     offset     0  ShmRingHeader, 1216 bytes
+//     offset  1216  ShmRingEvent[capacity], 32 bytes each
+// The player creates and initializes the segment, the producer maps it and then:
+//     1. writes the names of its devices in device_names, matched as in the json "devices" lists
+//     2. while write_index - read_index < capacity, writes the event at write_index % capacity
+//        and only then increments write_index, given that it's the index that publishes the event
+//     3. sets closed to 1 when done, so that the playing ends once all events are played
+// Event times are timeline times from the start of the playing, being timeline_ms its current one.
+
+struct ShmRingEvent {
+    double time_ms;                             //  0
+    uint8_t device;                             //  8 index in device_names
+    uint8_t size;                               //  9 bytes used in message
+    uint8_t message[SHM_MESSAGE_SIZE];          // 10 status byte followed by the data bytes
+};
+
+struct ShmRingHeader {
+    uint32_t magic;                             //    0
+    uint32_t version;                           //    4
+    uint32_t capacity;                          //    8
+    uint32_t event_size;                        //   12
+    std::atomic<uint32_t> closed;               //   16 written by the producer
+    uint32_t reserved[11];                      //   20
+    std::atomic<uint64_t> write_index;          //   64 written by the producer only
+    uint8_t write_padding[56];                  //   72 own cache line
+    std::atomic<uint64_t> read_index;           //  128 written by the player only
+    std::atomic<double> timeline_ms;            //  136 written by the player only
+    uint8_t read_padding[48];                   //  144 own cache line
+    char device_names[SHM_DEVICE_NAMES][SHM_DEVICE_NAME_SIZE];  // 192
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<double>::is_always_lock_free,
+    "Shared atomics shall be lock free");
+static_assert(sizeof(ShmRingEvent) == 32, "ShmRingEvent shall be 32 bytes");
+static_assert(sizeof(ShmRingHeader) == 1216, "ShmRingHeader shall be 1216 bytes");
+static_assert(offsetof(ShmRingHeader, write_index) == 64 && offsetof(ShmRingHeader, read_index) == 128,
+    "ShmRingHeader indexes shall be in their own cache lines");
+
+// The devices already resolved from the names in device_names
+struct ShmRingDevices {
+    std::string device_names[SHM_DEVICE_NAMES];
+    uint32_t device_ids[SHM_DEVICE_NAMES];
+
+    ShmRingDevices() {
+        std::fill(std::begin(device_ids), std::end(device_ids), no_device_id);
+    }
+};
+
+// Creates the named segment ready for a producer, nullptr if not possible
+ShmRingHeader *createShmRing(const char* shm_name, uint32_t capacity = SHM_RING_CAPACITY);
+void destroyShmRing(const char* shm_name, ShmRingHeader *shm_ring);
+// Adds the events written since the last call as pins, returns the number of events taken
+size_t takeShmEvents(ShmRingHeader *shm_ring, MidiDeviceResolver &device_resolver, ShmRingDevices &ring_devices,
+                        std::list<MidiPin> &midi_pins, PlayReporting &play_reporting);
+// Closed by the producer and with all its events taken
+bool isShmRingDone(ShmRingHeader *shm_ring);
+
+// Plays the events written in the named segment until the producer closes it
+int PlayShmRing(const char* shm_name, bool verbose = false);
+
+#endif // MIDI_JSON_PLAYER_SHM_HPP
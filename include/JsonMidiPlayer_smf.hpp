@@ -0,0 +1,55 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#ifndef MIDI_JSON_PLAYER_SMF_HPP
+#define MIDI_JSON_PLAYER_SMF_HPP
+
+#include <cstdint>
+#include "JsonMidiPlayer.hpp"
+
+#define SMF_DEFAULT_TEMPO 500000        // Microseconds per quarter note, 120 bpm
+#define SMF_EXPORT_TICKS_PER_QUARTER 5000   // With the default tempo each tick is 0.1 milliseconds
+
+const unsigned char smf_meta_event          = 0xFF; // Meta Event, in place of the System Reset
+const unsigned char smf_meta_text           = 0x01; // Text Event
+const unsigned char smf_meta_track_name     = 0x03; // Sequence or Track Name
+const unsigned char smf_meta_end_of_track   = 0x2F; // End of Track
+const unsigned char smf_meta_set_tempo      = 0x51; // Set Tempo, in microseconds per quarter note
+
+// The events of Standard MIDI Files ready to be played with PlayEvents or PlayInput
+struct SmfEvents {
+    std::vector<MidiEventRecord> events;
+    std::vector<std::string> device_names;
+    std::vector<const char*> device_names_table;
+    std::vector<unsigned char> sysex_data;
+    // Only valid while no more files are added
+    MidiEventsData getEventsData();
+};
+
+// Splits a comma separated list of device names, one per track
+std::vector<std::string> splitTrackDevices(const char* track_devices);
+// Starts with the "MThd" chunk of a Standard MIDI File
+bool isSmfData(const unsigned char* smf_data, size_t smf_size);
+// Adds the events of a format 0 or 1 file, each track played by the device with the same index in track_devices,
+// or by its last one for the tracks beyond it, being an empty name the first device available
+bool readSmfData(const unsigned char* smf_data, size_t smf_size, const std::vector<std::string> &track_devices,
+                    SmfEvents &smf_events, double offset_ms = 0.0);
+bool readSmfFile(const char* filename, const std::vector<std::string> &track_devices,
+                    SmfEvents &smf_events, double offset_ms = 0.0);
+// Writes the processed pins as a format 1 file, with a first track for the tempo and then one track
+// per device, named after it, being the system messages other than SysEx written as escaped bytes
+bool writeSmfFile(const char* filename, const std::list<MidiPin> &midi_pins);
+
+#endif // MIDI_JSON_PLAYER_SMF_HPP
@@ -17,6 +17,8 @@ https://github.com/ruiseixasm/JsonMidiPlayer
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <cstdlib>
+#include <iterator>
 
 // Testing program in the project folder
 //   Windows: .\build\Release\JsonMidiPlayer.exe -v .\windows_exported_lead_sheet_melody_jmp.json
@@ -32,13 +34,37 @@ https://github.com/ruiseixasm/JsonMidiPlayer
 #endif
 
 #include "JsonMidiPlayer.hpp"
+#include "JsonMidiPlayer_calibration.hpp"
+#include "JsonMidiPlayer_daemon.hpp"
+#include "JsonMidiPlayer_shm.hpp"
+#include "JsonMidiPlayer_smf.hpp"
 
 void printUsage(const char *programName) {
-    std::cout << "Usage: " << programName << " [options] input_file_1.json [input_file_2.json]\n"
+    std::cout << "Usage: " << programName << " [options] input_file_1.json [input_file_2.cbor|.msgpack|.mid]\n"
+              << "       " << programName << " [-v] [--cpu n] --daemon socket_path\n"
+              << "       " << programName << " [-v] --shm shm_name\n"
+              << "       " << programName << " [-v] --calibrate output_name,input_name\n"
               << "Options:\n"
               << "  -h, --help       Show this help message and exit\n"
               << "  -v, --verbose    Enable verbose mode\n"
-              << "  -V, --version    Prints the current version number\n\n"
+              << "  -V, --version    Prints the current version number\n"
+              << "  -s, --start ms   Starts playing at the given time in milliseconds\n"
+              << "  -l, --loop ms,ms Keeps looping the region between the given start and end times\n"
+              << "  -r, --rate rate  Plays at the given rate, like 0.5 for half the speed\n"
+              << "  -S, --sequential Plays the files one after the other instead of all together,\n"
+              << "                   either all json or all Standard MIDI Files\n"
+              << "  -g, --gap ms     Plays the files sequentially with the given gap in milliseconds\n"
+              << "  -d, --daemon path Keeps playing the submissions received on the given Unix socket\n"
+              << "  -m, --shm name   Plays the events written in the given shared memory ring until closed\n"
+              << "  -t, --tracks names Devices of the Standard MIDI File tracks, comma separated, the last one for the remaining\n"
+              << "  -e, --export-smf file Writes the processed timeline to the given Standard MIDI File instead of playing it\n"
+              << "  -b, --bandwidth name=kbaud,... Port rates of the devices whose names contain name, 31.25 for DIN and 0 for no limit\n"
+              << "  -T, --thin name=rate,... Thins the controller and pitch bend curves of the devices to rate messages per second\n"
+              << "      --thin-tolerance steps Value deviation allowed to the thinned curves turns, 1 by default\n"
+              << "  -L, --late-policy policy When behind, \"drag\" shifts the timeline and \"catch-up\" skips the superseded automation\n"
+              << "  -o, --latency name=ms,... Sends the whole stream of the devices this earlier, compensating their output latency\n"
+              << "  -c, --calibrate output,input Measures the round trip from an output port looped back into an input port\n"
+              << "  -C, --cpu n      Pins the playing and the output workers to the given CPU, the daemon defaults to the last one\n\n"
               << "More info here: https://github.com/ruiseixasm/JsonMidiPlayer\n\n";
 }
 
@@ -46,16 +72,48 @@ int main(int argc, char *argv[]) {
 
     int verbose = 0;
     int option_index = 0;
+    double start_ms = -1.0;
+    double loop_start_ms = 0.0;
+    double loop_end_ms = -1.0;
+    double playing_rate = 1.0;
+    double sequential_gap_ms = -1.0;    // Negative plays all files together
+    const char *daemon_socket = nullptr;
+    const char *shm_name = nullptr;
+    std::vector<std::string> track_devices;
+    const char *export_smf = nullptr;
+    std::vector<DeviceSetting> device_bandwidths;
+    std::vector<DeviceSetting> device_thinning;
+    double thinning_tolerance = THINNING_TOLERANCE;
+    unsigned char late_policy = late_policy_drag;
+    std::vector<DeviceSetting> device_latencies;
+    const char *loopback_ports = nullptr;
+    int playing_cpu = -1;               // Negative for none, or for the last CPU in daemon mode
 
     struct option long_options[] = {
         {"help",    no_argument,       nullptr, 'h'},
         {"verbose", no_argument,       nullptr, 'v'},
         {"version", no_argument,       nullptr, 'V'}, // New option for version
+        {"start",   required_argument, nullptr, 's'},
+        {"loop",    required_argument, nullptr, 'l'},
+        {"rate",    required_argument, nullptr, 'r'},
+        {"sequential", no_argument,    nullptr, 'S'},
+        {"gap",     required_argument, nullptr, 'g'},
+        {"daemon",  required_argument, nullptr, 'd'},
+        {"shm",     required_argument, nullptr, 'm'},
+        {"tracks",  required_argument, nullptr, 't'},
+        {"export-smf", required_argument, nullptr, 'e'},
+        {"bandwidth", required_argument, nullptr, 'b'},
+        {"thin",    required_argument, nullptr, 'T'},
+        {"thin-tolerance", required_argument, nullptr, 256},   // Long option only
+        {"late-policy", required_argument, nullptr, 'L'},
+        {"latency", required_argument, nullptr, 'o'},
+        {"calibrate", required_argument, nullptr, 'c'},
+        {"cpu",     required_argument, nullptr, 'C'},
         {nullptr,   0,                 nullptr,  0 }
     };
 
     while (true) {
-        int c = getopt_long(argc, argv, "hvV", long_options, &option_index);
+        int c = getopt_long(argc, argv, "hvVs:l:r:Sg:d:m:t:e:b:T:L:o:c:C:", long_options, &option_index);
         if (c == -1) break;
 
         switch (c) {
@@ -68,6 +126,86 @@ int main(int argc, char *argv[]) {
             case 'V': // Handle the --version option
                 std::cout << "JsonMidiPlayer " << VERSION << std::endl;
                 return 0;   // Exit after printing the version
+            case 's':
+                start_ms = std::atof(optarg);
+                break;
+            case 'l':
+            {
+                char *loop_end_str = nullptr;
+                loop_start_ms = std::strtod(optarg, &loop_end_str);
+                if (*loop_end_str != ',') {
+                    std::cerr << "Error: The loop region shall be given as start_ms,end_ms\n";
+                    return 1;
+                }
+                loop_end_ms = std::atof(loop_end_str + 1);
+                break;
+            }
+            case 'r':
+                playing_rate = std::atof(optarg);
+                if (playing_rate <= 0.0) {
+                    std::cerr << "Error: The playing rate shall be positive\n";
+                    return 1;
+                }
+                break;
+            case 'S':
+                if (sequential_gap_ms < 0.0)
+                    sequential_gap_ms = 0.0;
+                break;
+            case 'g':
+                sequential_gap_ms = std::atof(optarg);
+                if (sequential_gap_ms < 0.0) {
+                    std::cerr << "Error: The gap between files shall not be negative\n";
+                    return 1;
+                }
+                break;
+            case 'd':
+                daemon_socket = optarg;
+                break;
+            case 'm':
+                shm_name = optarg;
+                break;
+            case 't':
+                track_devices = splitTrackDevices(optarg);
+                break;
+            case 'e':
+                export_smf = optarg;
+                break;
+            case 'b':
+                device_bandwidths = readDeviceSettings(optarg);
+                break;
+            case 'T':
+                device_thinning = readDeviceSettings(optarg);
+                break;
+            case 'L':
+                if (std::string(optarg) == "drag") {
+                    late_policy = late_policy_drag;
+                } else if (std::string(optarg) == "catch-up") {
+                    late_policy = late_policy_catch_up;
+                } else {
+                    std::cerr << "Error: The late policy shall be drag or catch-up\n";
+                    return 1;
+                }
+                break;
+            case 'o':
+                device_latencies = readDeviceSettings(optarg);
+                break;
+            case 'c':
+                loopback_ports = optarg;
+                break;
+            case 'C':
+                playing_cpu = std::atoi(optarg);
+                if (playing_cpu < 0) {
+                    std::cerr << "Error: The CPU shall not be negative\n";
+                    return 1;
+                }
+                break;
+            case 256:
+                thinning_tolerance = std::atof(optarg);
+                if (thinning_tolerance < 0.0) {
+                    std::cerr << "Error: The thinning tolerance shall not be negative\n";
+                    return 1;
+                }
+                break;
             case '?':
                 // getopt_long already printed an error message.
                 return 1;
@@ -76,6 +214,13 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    if (daemon_socket != nullptr)
+        return PlayDaemon(daemon_socket, verbose, playing_cpu);
+    if (shm_name != nullptr)
+        return PlayShmRing(shm_name, verbose);
+    if (loopback_ports != nullptr)
+        return CalibrateLatency(loopback_ports, verbose);
+
     if (optind + 1 > argc) {    // optind points to the first non-option argument (at least 1 file)
         std::cerr << "Error: Missing input file(s)\n";
         printUsage(argv[0]);
@@ -83,26 +228,64 @@ int main(int argc, char *argv[]) {
     }
 
     int read_files = 0;
-    std::stringstream json_files_buffer;
-    json_files_buffer << "[";
+    SmfEvents smf_events;   // Standard MIDI Files are played together with the json ones
+    double smf_offset_ms = 0.0; // Where the next Standard MIDI File starts when sequential
+    std::vector<InputDocument> input_documents;
     for (size_t filename_position = optind; filename_position < argc; filename_position++) {
 
         const char* filename = argv[filename_position];
-        std::ifstream json_file(filename);
-        if (!json_file.is_open()) {
+        std::ifstream input_file(filename, std::ios::binary);
+        if (!input_file.is_open()) {
             std::cerr << "Could not open the file: " << filename << std::endl;
             continue;
         }
+        std::string file_content((std::istreambuf_iterator<char>(input_file)), std::istreambuf_iterator<char>());
+        input_file.close();
+        const unsigned char *file_data = reinterpret_cast<const unsigned char*>(file_content.data());
+        if (isSmfData(file_data, file_content.size())) {
+            if (!readSmfData(file_data, file_content.size(), track_devices, smf_events, smf_offset_ms)) {
+                std::cerr << "Could not read the Standard MIDI File: " << filename << std::endl;
+                continue;
+            }
+            if (sequential_gap_ms >= 0.0) {
+                for (const MidiEventRecord &smf_event : smf_events.events)
+                    smf_offset_ms = std::max(smf_offset_ms, smf_event.time_ms + sequential_gap_ms);
+            }
+        } else {
+            // Json, CBOR or MessagePack, by its extension or by its first bytes
+            unsigned char input_format = getInputFormat(file_data, file_content.size(), filename);
+            input_documents.push_back({ std::move(file_content), input_format });
+        }
         read_files++;
-        json_files_buffer << json_file.rdbuf() << ",";
-        json_file.close();
     }
     if (read_files == 0)
         return 1;
+    if (sequential_gap_ms >= 0.0 && !smf_events.events.empty() && !input_documents.empty()) {
+        // The json files are only sequenced while played, so there is no end to start the Standard MIDI Files at
+        std::cerr << "Error: Sequential playing of Standard MIDI Files together with json files\n";
+        return 1;
+    }
     
-    std::string json_files_list = json_files_buffer.str();
-    // Replace last "," with a "]"
-    json_files_list.back() = ']';
+    MidiEventsData events_data = smf_events.getEventsData();
+    const MidiEventsData *smf_events_data = smf_events.events.empty() ? nullptr : &events_data;
 
-    return PlayList(json_files_list.c_str(), verbose);
+    if (start_ms > 0.0 || loop_end_ms > loop_start_ms || playing_rate != 1.0 || sequential_gap_ms >= 0.0 || export_smf != nullptr
+            || device_bandwidths.size() > 0 || device_thinning.size() > 0 || late_policy != late_policy_drag
+            || device_latencies.size() > 0 || playing_cpu >= 0) {
+        PlayControl play_control;
+        play_control.seek_ms.store(start_ms);  // Seeks right before playing
+        play_control.loop_start_ms.store(loop_start_ms);
+        play_control.loop_end_ms.store(loop_end_ms);
+        play_control.playing_rate.store(playing_rate);
+        play_control.sequential_gap_ms.store(sequential_gap_ms);
+        play_control.export_smf = export_smf;
+        play_control.device_bandwidths = device_bandwidths;
+        play_control.device_thinning = device_thinning;
+        play_control.thinning_tolerance = thinning_tolerance;
+        play_control.late_policy = late_policy;
+        play_control.device_latencies = device_latencies;
+        play_control.playing_cpu = playing_cpu;
+        return PlayInput(input_documents, smf_events_data, verbose, &play_control);
+    }
+    return PlayInput(input_documents, smf_events_data, verbose);
 }
@@ -17,6 +17,17 @@ import platform
 import os
 import ctypes
 
+# Same layout as the MidiEventRecord of the binary events input, 16 bytes each
+class MidiEventRecord(ctypes.Structure):
+    _fields_ = [
+        ("time_ms", ctypes.c_double),
+        ("device", ctypes.c_uint8),
+        ("status_byte", ctypes.c_uint8),
+        ("data_byte_1", ctypes.c_uint8),
+        ("data_byte_2", ctypes.c_uint8),
+        ("sysex_offset", ctypes.c_uint32)
+    ]
+
 # Determine the directory of the current Python file
 script_dir = os.path.dirname(os.path.abspath(__file__))
 
@@ -50,6 +61,56 @@ else:
         result = lib.add_ctypes(3, 4)
         print(f"3 + 4 = {result}")
 
+        # Non blocking playing, the handle is released by PlayList_wait_ctypes
+        lib.PlayList_start_ctypes.argtypes = [ctypes.c_char_p, ctypes.c_int]
+        lib.PlayList_start_ctypes.restype = ctypes.c_void_p
+        for function_name in ("PlayList_stop_ctypes", "PlayList_pause_ctypes", "PlayList_resume_ctypes"):
+            getattr(lib, function_name).argtypes = [ctypes.c_void_p]
+            getattr(lib, function_name).restype = None
+        lib.PlayList_seek_ctypes.argtypes = [ctypes.c_void_p, ctypes.c_double]
+        lib.PlayList_seek_ctypes.restype = None
+        lib.PlayList_loop_ctypes.argtypes = [ctypes.c_void_p, ctypes.c_double, ctypes.c_double]
+        lib.PlayList_loop_ctypes.restype = None
+        lib.PlayList_rate_ctypes.argtypes = [ctypes.c_void_p, ctypes.c_double]
+        lib.PlayList_rate_ctypes.restype = None
+        # Streaming playing, the fragments are appended while playing until closed
+        lib.PlayList_stream_ctypes.argtypes = [ctypes.c_char_p, ctypes.c_int]
+        lib.PlayList_stream_ctypes.restype = ctypes.c_void_p
+        lib.PlayList_ring_ctypes.argtypes = [ctypes.c_char_p, ctypes.c_int]
+        lib.PlayList_ring_ctypes.restype = ctypes.c_void_p
+        # Binary events, without any json
+        events_argtypes = [ctypes.POINTER(MidiEventRecord), ctypes.c_size_t,
+                           ctypes.POINTER(ctypes.c_char_p), ctypes.c_size_t,
+                           ctypes.POINTER(ctypes.c_ubyte), ctypes.c_size_t, ctypes.c_int]
+        lib.PlayList_events_ctypes.argtypes = events_argtypes
+        lib.PlayList_events_ctypes.restype = ctypes.c_int
+        lib.PlayList_events_start_ctypes.argtypes = events_argtypes
+        lib.PlayList_events_start_ctypes.restype = ctypes.c_void_p
+        # Standard MIDI Files, with the comma separated devices of their tracks
+        lib.PlayList_smf_ctypes.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int]
+        lib.PlayList_smf_ctypes.restype = ctypes.c_int
+        lib.PlayList_smf_start_ctypes.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int]
+        lib.PlayList_smf_start_ctypes.restype = ctypes.c_void_p
+        lib.PlayList_append_ctypes.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+        lib.PlayList_append_ctypes.restype = None
+        # Json, CBOR or MessagePack bytes, like the ones of cbor2.dumps or msgpack.packb
+        lib.PlayList_data_ctypes.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int]
+        lib.PlayList_data_ctypes.restype = ctypes.c_int
+        lib.PlayList_data_start_ctypes.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int]
+        lib.PlayList_data_start_ctypes.restype = ctypes.c_void_p
+        lib.PlayList_append_data_ctypes.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t]
+        lib.PlayList_append_data_ctypes.restype = None
+        lib.PlayList_close_ctypes.argtypes = [ctypes.c_void_p]
+        lib.PlayList_close_ctypes.restype = None
+        lib.PlayList_late_ctypes.argtypes = [ctypes.c_void_p]
+        lib.PlayList_late_ctypes.restype = ctypes.c_size_t
+        for function_name in ("PlayList_progress_ctypes", "PlayList_duration_ctypes", "PlayList_timeline_ctypes"):
+            getattr(lib, function_name).argtypes = [ctypes.c_void_p]
+            getattr(lib, function_name).restype = ctypes.c_double
+        for function_name in ("PlayList_playing_ctypes", "PlayList_wait_ctypes"):
+            getattr(lib, function_name).argtypes = [ctypes.c_void_p]
+            getattr(lib, function_name).restype = ctypes.c_int
+
     except FileNotFoundError:
         print(f"Could not find the library file: {lib_path}")
     except OSError as e:
@@ -14,11 +14,93 @@ https://github.com/ruiseixasm/JsonMidiCreator
 https://github.com/ruiseixasm/JsonMidiPlayer
 */
 #include "JsonMidiPlayer.hpp"
+#include "JsonMidiPlayer_parser.hpp"
+#include "JsonMidiPlayer_jack.hpp"
+#include "JsonMidiPlayer_rawmidi.hpp"
+#include "JsonMidiPlayer_shm.hpp"
+#include "JsonMidiPlayer_smf.hpp"
 
 // MidiPin methods definition
-void MidiPin::pluckTooth() {
+void MidiPin::pluckTooth(double late_ms) {
     if (midi_device != nullptr)
-        midi_device->sendMessage(&midi_message);
+        midi_device->sendMessage(&midi_message, late_ms);
+}
+
+unsigned char MidiPin::getMessageClass() const {
+    switch (getAction()) {
+        case action_note_off:
+        case action_note_on:
+            return class_note;
+        case action_control_change:
+            return class_control_change;
+        case action_pitch_bend:
+            return class_pitch_bend;
+        case action_system:
+            switch (getStatusByte()) {
+                case system_timing_clock:
+                    return class_clock;
+                case system_clock_start:
+                case system_clock_continue:
+                case system_clock_stop:
+                case system_song_pointer:
+                    return class_transport;
+                case system_sysex_start:
+                    // MMC commands are Universal Real Time SysEx (F0 7F <device> 06 <command> F7)
+                    if (midi_message.size() > 4 && midi_message[1] == 0x7F && midi_message[3] == 0x06)
+                        return class_transport;
+                    return class_sysex;
+            }
+            break;
+    }
+    return class_other;
+}
+
+
+// OutputQueue methods definition
+bool OutputQueue::push(const unsigned char *midi_message, size_t message_size, double late_ms) {
+    const size_t pushing_index = write_index.load(std::memory_order_relaxed);
+    if (pushing_index - read_index.load(std::memory_order_acquire) >= output_messages.size())
+        return false;
+    OutputMessage &output_message = output_messages[pushing_index % output_messages.size()];
+    output_message.midi_message.assign(midi_message, midi_message + message_size);
+    output_message.late_ms = late_ms;
+    output_message.pushed_time = std::chrono::high_resolution_clock::now();
+    write_index.store(pushing_index + 1, std::memory_order_release);
+    return true;
+}
+
+OutputQueue::OutputMessage *OutputQueue::front() {
+    const size_t popping_index = read_index.load(std::memory_order_relaxed);
+    if (popping_index == write_index.load(std::memory_order_acquire))
+        return nullptr;
+    return &output_messages[popping_index % output_messages.size()];
+}
+
+void OutputQueue::pop() {
+    read_index.store(read_index.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void OutputQueue::wake() {
+    // Locked so that the worker can't miss it between checking the queue and waiting
+    { std::lock_guard<std::mutex> lock(waking_mutex); }
+    waking_condition.notify_one();
+}
+
+void OutputQueue::wait(long long timeout_us) {
+    std::unique_lock<std::mutex> lock(waking_mutex);
+    waking_condition.wait_for(lock, std::chrono::microseconds(timeout_us), [this]() {
+        return read_index.load(std::memory_order_relaxed) != write_index.load(std::memory_order_acquire)
+            || closed_queue.load();
+    });
+}
+
+void OutputQueue::close() {
+    closed_queue.store(true);
+    wake();
+}
+
+bool OutputQueue::isClosed() const {
+    return closed_queue.load();
 }
 
 
@@ -26,9 +108,15 @@ void MidiPin::pluckTooth() {
 bool MidiDevice::openPort() {
     if (!opened_port && !unavailable_device) {
         try {
-            midiOut.openPort(port);
-            opened_port = true;
-            if (verbose) std::cout << "   " << name;
+            if (direct_out)
+                direct_out->openPort();
+            else
+                midiOut.openPort(port);
+            output_queue = std::make_unique<OutputQueue>();
+            output_worker = std::thread(&MidiDevice::writeOutputQueue, this);
+            // Only published once its queue and worker are set, given that the playing may be running
+            opened_port.store(true, std::memory_order_release);
+            if (verbose) std::cout << "   " + name;   // A single write, the ports may be opened concurrently
         } catch (RtMidiError &error) {
             unavailable_device = true;
             error.printMessage();
@@ -39,7 +127,11 @@ bool MidiDevice::openPort() {
 
 void MidiDevice::closePort() {
     if (opened_port) {
-        midiOut.closePort();
+        drainOutput();
+        if (direct_out)
+            direct_out->closePort();
+        else
+            midiOut.closePort();
         opened_port = false;
         if (verbose) std::cout << "   " << name;
     }
@@ -57,10 +149,556 @@ unsigned int MidiDevice::getDevicePort() const {
     return port;
 }
 
-void MidiDevice::sendMessage(const std::vector<unsigned char> *midi_message) {
-    midiOut.sendMessage(midi_message);
+void MidiDevice::writeMessage(const unsigned char *midi_message, size_t message_size, double late_ms) {
+    if (!opened_port.load(std::memory_order_acquire))
+        return;
+    if (output_queue) {
+        if (output_queue->push(midi_message, message_size, late_ms))
+            queued_messages = true;
+        else
+            output_reporting.dropped_messages++;    // Its worker is stuck on the port
+    } else if (direct_out) {
+        direct_out->sendMessage(midi_message, message_size, late_ms);
+    } else {
+        midiOut.sendMessage(midi_message, message_size);
+    }
+    if (byte_time_ms > 0.0) {
+        // Estimated by the port rate, being each message sent after the bytes already given to the port
+        auto writing_time = std::chrono::high_resolution_clock::now();
+        auto wire_start = std::max(writing_time, wire_free_time);
+        wire_free_time = wire_start + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+            std::chrono::duration<double, std::milli>(message_size * byte_time_ms));
+        if (midi_message[0] == system_timing_clock) {
+            double wire_delay_ms = std::chrono::duration<double, std::milli>(wire_start - writing_time).count();
+            byte_stream_reporting.total_clocks++;
+            byte_stream_reporting.total_clock_wire_delay += wire_delay_ms;
+            byte_stream_reporting.squared_clock_wire_delay += wire_delay_ms * wire_delay_ms;
+            byte_stream_reporting.maximum_clock_wire_delay = std::max(byte_stream_reporting.maximum_clock_wire_delay, wire_delay_ms);
+        }
+    }
+}
+
+void MidiDevice::sendMessage(const std::vector<unsigned char> *midi_message, double late_ms) {
+    const unsigned char status_byte = (*midi_message)[0];
+    // Only the Real-Time messages may go in between the chunks of a SysEx
+    if (status_byte < 0xF8 && hasSysExChunks())
+        finishSysEx();
+    if (status_byte == system_sysex_start && midi_message->size() > SYSEX_CHUNK_BYTES && isByteStream()) {
+        sysex_chunks.assign(midi_message->begin(), midi_message->end());
+        sysex_sent_bytes = 0;
+        byte_stream_reporting.fragmented_sysex++;
+        sendSysExChunk();
+    } else {
+        writeMessage(midi_message->data(), midi_message->size(), late_ms);
+    }
+    // Keeps track of the pressed notes and of the clock, needed to stop or to pause the playing
+    switch (status_byte & 0xF0) {
+        case action_note_off:
+            pressed_notes[status_byte & 0x0F][(*midi_message)[1]] = false;
+            break;
+        case action_note_on:
+            pressed_notes[status_byte & 0x0F][(*midi_message)[1]] = (*midi_message)[2] > 0;
+            break;
+        case action_system:
+            switch (status_byte) {
+                case system_clock_start:
+                case system_clock_continue:
+                    clock_running = true;
+                    break;
+                case system_clock_stop:
+                    clock_running = false;
+                    break;
+            }
+            break;
+    }
+}
+
+void MidiDevice::flushMessages() {
+    if (!opened_port.load(std::memory_order_acquire))
+        return;     // Its port may still be being opened by another thread
+    if (output_queue) {
+        if (queued_messages) {
+            queued_messages = !output_queue->push(nullptr, 0, 0.0);    // Or by the next flush
+            output_queue->wake();
+        }
+    } else if (direct_out) {
+        direct_out->flush();
+    }
+}
+
+// Runs on its own thread while the port is open, being the only one writing to the port
+void MidiDevice::writeOutputQueue() {
+    setRealTimeScheduling();
+    if (output_cpu >= 0 && !setThreadAffinity(output_cpu) && pinning_failed != nullptr)
+        pinning_failed->store(true);
+    bool pending_bytes = false;     // The port didn't take all the bytes of the last flush
+    while (true) {
+        OutputQueue::OutputMessage *output_message = output_queue->front();
+        if (output_message == nullptr) {
+            if (output_queue->isClosed()) {
+                if (output_queue->front() != nullptr)
+                    continue;   // Pushed right before being closed
+                break;
+            }
+            output_queue->wait(pending_bytes ? OUTPUT_RETRY_US : CONTROL_POLLING_US);
+            if (pending_bytes)
+                pending_bytes = !direct_out->flush();
+            continue;
+        }
+        const double queue_delay_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - output_message->pushed_time).count();
+        try {
+            if (output_message->midi_message.empty()) {
+                if (direct_out)
+                    pending_bytes = !direct_out->flush();
+            } else {
+                if (direct_out)
+                    direct_out->sendMessage(output_message->midi_message.data(), output_message->midi_message.size(),
+                                            output_message->late_ms + queue_delay_ms);
+                else
+                    midiOut.sendMessage(output_message->midi_message.data(), output_message->midi_message.size());
+                output_reporting.total_messages++;
+                output_reporting.total_queue_delay += queue_delay_ms;
+                output_reporting.maximum_queue_delay = std::max(output_reporting.maximum_queue_delay, queue_delay_ms);
+            }
+        } catch (RtMidiError &error) {
+            output_reporting.failed_messages++;     // Like an unplugged device, only its own messages are lost
+            error.printMessage();
+        }
+        output_queue->pop();
+    }
+    if (direct_out)
+        direct_out->flush();
+}
+
+void MidiDevice::setOutputCpu(int output_cpu, std::atomic<bool> *pinning_failed) {
+    this->output_cpu = output_cpu;
+    this->pinning_failed = pinning_failed;
+}
+
+void MidiDevice::drainOutput() {
+    if (output_worker.joinable()) {
+        output_queue->close();
+        output_worker.join();
+    }
+    output_queue.reset();
+    queued_messages = false;
+}
+
+const MidiDevice::OutputReporting &MidiDevice::getOutputReporting() const {
+    return output_reporting;
+}
+
+const char *MidiDevice::getNamePrefix() const {
+    return direct_out ? direct_out->getNamePrefix() : "";
+}
+
+bool MidiDevice::isByteStream() const {
+    return direct_out && direct_out->isByteStream();
+}
+
+void MidiDevice::setByteTime(double byte_time_ms) {
+    this->byte_time_ms = std::max(0.0, byte_time_ms);
+}
+
+double MidiDevice::getByteTime() const {
+    return byte_time_ms;
+}
+
+void MidiDevice::setThinning(double messages_per_second, double value_tolerance) {
+    thinning_interval_ms = messages_per_second > 0.0 ? 1000.0 / messages_per_second : 0.0;
+    thinning_tolerance = std::max(0.0, value_tolerance);
+}
+
+double MidiDevice::getThinningInterval() const {
+    return thinning_interval_ms;
+}
+
+double MidiDevice::getThinningTolerance() const {
+    return thinning_tolerance;
+}
+
+void MidiDevice::setLatency(double latency_ms) {
+    this->latency_ms = std::max(0.0, latency_ms);
+}
+
+double MidiDevice::getLatency() const {
+    return latency_ms;
+}
+
+bool MidiDevice::hasSysExChunks() const {
+    return sysex_sent_bytes < sysex_chunks.size();
+}
+
+// The next chunk is due when the port is estimated to have sent the previous one
+std::chrono::high_resolution_clock::time_point MidiDevice::getChunkTime() const {
+    return wire_free_time;
+}
+
+void MidiDevice::sendSysExChunk() {
+    size_t chunk_size = std::min<size_t>(SYSEX_CHUNK_BYTES, sysex_chunks.size() - sysex_sent_bytes);
+    writeMessage(sysex_chunks.data() + sysex_sent_bytes, chunk_size, 0.0);
+    sysex_sent_bytes += chunk_size;
+    byte_stream_reporting.sent_chunks++;
+    if (sysex_sent_bytes == sysex_chunks.size()) {
+        sysex_chunks.clear();
+        sysex_sent_bytes = 0;
+    }
+}
+
+void MidiDevice::finishSysEx() {
+    while (hasSysExChunks())
+        sendSysExChunk();
+}
+
+const MidiDevice::ByteStreamReporting &MidiDevice::getByteStreamReporting() const {
+    return byte_stream_reporting;
+}
+
+bool MidiDevice::isClockRunning() const {
+    return clock_running;
+}
+
+// Sends a clock Stop if the clock is running, returning true if so
+bool MidiDevice::stopClock() {
+    if (clock_running) {
+        std::vector<unsigned char> clock_stop_message = { system_clock_stop };
+        sendMessage(&clock_stop_message);
+        return true;
+    }
+    return false;
+}
+
+// Fast all notes off, sends a Note Off for every note still pressed
+void MidiDevice::releaseNotes() {
+    if (opened_port) {
+        for (unsigned char channel = 0; channel < 16; channel++) {
+            if (pressed_notes[channel].none())
+                continue;
+            for (unsigned char pitch = 0; pitch < 128; pitch++) {
+                if (pressed_notes[channel][pitch]) {
+                    std::vector<unsigned char> note_off_message = {
+                        static_cast<unsigned char>(action_note_off | channel), pitch,
+                        0	// Note off has velocity 0 (Data Byte 2)
+                    };
+                    sendMessage(&note_off_message);
+                }
+            }
+        }
+    }
+}
+
+
+
+// MidiState methods definition
+MidiState::MidiState() {
+    for (auto &channel_controls : control_change)
+        channel_controls.fill(-1);
+    program_change.fill(-1);
+    channel_pressure.fill(-1);
+    pitch_bend.fill(-1);
+    for (auto &channel_notes : note_velocity)
+        channel_notes.fill(0);
+}
+
+void MidiState::updateState(const MidiPin &midi_pin) {
+    const unsigned char channel = midi_pin.getChannel();
+    switch (midi_pin.getAction()) {
+        case action_note_off:
+            note_velocity[channel][midi_pin.getDataByte(1)] = 0;
+            break;
+        case action_note_on:
+            note_velocity[channel][midi_pin.getDataByte(1)] = midi_pin.getDataByte(2);  // Velocity 0 is a Note Off
+            break;
+        case action_control_change:
+            if (midi_pin.getDataByte(1) < 120) {
+                control_change[channel][midi_pin.getDataByte(1)] = midi_pin.getDataByte(2);
+            } else if (midi_pin.getDataByte(1) == 121) {    // Reset All Controllers
+                control_change[channel].fill(-1);
+                pitch_bend[channel] = -1;
+                channel_pressure[channel] = -1;
+            } else if (midi_pin.getDataByte(1) == 123) {    // All Notes Off
+                note_velocity[channel].fill(0);
+            }
+            break;
+        case action_program_change:
+            program_change[channel] = midi_pin.getDataByte(1);
+            break;
+        case action_channel_pressure:
+            channel_pressure[channel] = midi_pin.getDataByte(1);
+            break;
+        case action_pitch_bend:
+            pitch_bend[channel] = midi_pin.getDataByte(1) | midi_pin.getDataByte(2) << 7;
+            break;
+        case action_system:
+            switch (midi_pin.getStatusByte()) {
+                case system_clock_start:
+                    clock_running = true;
+                    clock_pulses = 0;
+                    break;
+                case system_clock_continue:
+                    clock_running = true;
+                    break;
+                case system_timing_clock:
+                    clock_pulses++;
+                    break;
+                case system_clock_stop:
+                    clock_running = false;
+                    break;
+            }
+            break;
+    }
+}
+
+void MidiState::chaseState(MidiDevice *midi_device, double time_ms, std::vector<MidiPin> &chase_pins) const {
+    for (unsigned char channel = 0; channel < 16; channel++) {
+        // Bank Select comes before the Program Change
+        for (unsigned char bank_select : { 0, 32 }) {
+            if (control_change[channel][bank_select] >= 0) {
+                chase_pins.push_back(MidiPin(time_ms, midi_device, {
+                    static_cast<unsigned char>(action_control_change | channel), bank_select,
+                    static_cast<unsigned char>(control_change[channel][bank_select]) }, 0x10));
+            }
+        }
+        if (program_change[channel] >= 0) {
+            chase_pins.push_back(MidiPin(time_ms, midi_device, {
+                static_cast<unsigned char>(action_program_change | channel),
+                static_cast<unsigned char>(program_change[channel]) }, 0x11));
+        }
+        for (unsigned char control = 1; control < 120; control++) {
+            if (control != 32 && control_change[channel][control] >= 0) {
+                chase_pins.push_back(MidiPin(time_ms, midi_device, {
+                    static_cast<unsigned char>(action_control_change | channel), control,
+                    static_cast<unsigned char>(control_change[channel][control]) }, 0x20 | channel));
+            }
+        }
+        if (pitch_bend[channel] >= 0) {
+            chase_pins.push_back(MidiPin(time_ms, midi_device, {
+                static_cast<unsigned char>(action_pitch_bend | channel),
+                static_cast<unsigned char>(pitch_bend[channel] & 0x7F),
+                static_cast<unsigned char>(pitch_bend[channel] >> 7) }, 0x70 | channel));
+        }
+        if (channel_pressure[channel] >= 0) {
+            chase_pins.push_back(MidiPin(time_ms, midi_device, {
+                static_cast<unsigned char>(action_channel_pressure | channel),
+                static_cast<unsigned char>(channel_pressure[channel]) }, 0x80 | channel));
+        }
+        for (unsigned char pitch = 0; pitch < 128; pitch++) {
+            if (note_velocity[channel][pitch] > 0) {
+                chase_pins.push_back(MidiPin(time_ms, midi_device, {
+                    static_cast<unsigned char>(action_note_on | channel), pitch,
+                    note_velocity[channel][pitch] }, 0x50 | channel));
+            }
+        }
+    }
+    if (clock_running) {
+        // Song Position Pointer counts MIDI Beats (6 clock pulses each) and the clock resumes with Continue
+        unsigned int midi_beats = std::min(clock_pulses / 6, 0x3FFFu);
+        chase_pins.push_back(MidiPin(time_ms, midi_device, {
+            system_song_pointer,
+            static_cast<unsigned char>(midi_beats & 0x7F),
+            static_cast<unsigned char>(midi_beats >> 7) }, 0xB1));
+        chase_pins.push_back(MidiPin(time_ms, midi_device, { system_clock_continue }, 0x31));
+    }
+}
+
+void MidiState::releaseState(MidiDevice *midi_device, double time_ms, std::vector<MidiPin> &release_pins) const {
+    for (unsigned char channel = 0; channel < 16; channel++) {
+        for (unsigned char pitch = 0; pitch < 128; pitch++) {
+            if (note_velocity[channel][pitch] > 0) {
+                release_pins.push_back(MidiPin(time_ms, midi_device, {
+                    static_cast<unsigned char>(action_note_off | channel), pitch, 0 }, 0x40 | channel));
+            }
+        }
+    }
+    if (clock_running)
+        release_pins.push_back(MidiPin(time_ms, midi_device, { system_clock_stop }, 0xB0));
+}
+
+
+// Takes a snapshot of all devices states every CHECKPOINT_INTERVAL_MS
+std::vector<MidiCheckpoint> buildCheckpoints(std::list<MidiPin> &midi_pins) {
+    std::vector<MidiCheckpoint> checkpoints;
+    std::unordered_map<MidiDevice*, MidiState> device_states;
+    double next_checkpoint_ms = 0.0;
+    for (auto pin_it = midi_pins.begin(); pin_it != midi_pins.end(); ++pin_it) {
+        if (pin_it->getTime() >= next_checkpoint_ms) {
+            checkpoints.push_back({ pin_it->getTime(), pin_it, device_states });
+            next_checkpoint_ms = pin_it->getTime() + CHECKPOINT_INTERVAL_MS;
+        }
+        device_states[pin_it->getDevice()].updateState(*pin_it);
+    }
+    return checkpoints;
+}
+
+// Returns the first pin at or after seek_ms and sets the device_states right before it
+std::list<MidiPin>::iterator seekMidiStates(std::list<MidiPin> &midi_pins, const std::vector<MidiCheckpoint> &checkpoints,
+                                            double seek_ms, std::unordered_map<MidiDevice*, MidiState> &device_states) {
+    // Binary search of the last checkpoint at or before seek_ms
+    auto checkpoint_it = std::upper_bound(checkpoints.begin(), checkpoints.end(), seek_ms,
+        [](double time_ms, const MidiCheckpoint &checkpoint) { return time_ms < checkpoint.time_ms; });
+    
+    auto pin_it = midi_pins.begin();
+    if (checkpoint_it != checkpoints.begin())
+        --checkpoint_it;
+    if (checkpoint_it != checkpoints.end()) {
+        // Before the first checkpoint is before the first pin, unless the earlier pins were trimmed
+        device_states = checkpoint_it->device_states;
+        pin_it = checkpoint_it->first_pin;
+    }
+    // Short replay from the checkpoint up to seek_ms
+    for (; pin_it != midi_pins.end() && pin_it->getTime() < seek_ms; ++pin_it)
+        device_states[pin_it->getDevice()].updateState(*pin_it);
+    return pin_it;
+}
+
+// Returns the first pin at or after seek_ms and sets the chase_pins that put the devices in their state at seek_ms
+std::list<MidiPin>::iterator seekMidiPins(std::list<MidiPin> &midi_pins, const std::vector<MidiCheckpoint> &checkpoints,
+                                            double seek_ms, std::vector<MidiPin> &chase_pins) {
+    std::unordered_map<MidiDevice*, MidiState> device_states;
+    auto pin_it = seekMidiStates(midi_pins, checkpoints, seek_ms, device_states);
+    // Notes released right at seek_ms aren't worth chasing
+    for (auto release_it = pin_it; release_it != midi_pins.end() && release_it->getTime() == seek_ms; ++release_it) {
+        if (release_it->getAction() == action_note_off)
+            device_states[release_it->getDevice()].updateState(*release_it);
+    }
+    for (auto &device_state : device_states)
+        device_state.second.chaseState(device_state.first, seek_ms, chase_pins);
+    return pin_it;
+}
+
+// Drops the pins before the last checkpoint at or before keep_ms, the one left first still has their states
+void trimMidiPins(std::list<MidiPin> &midi_pins, std::vector<MidiCheckpoint> &checkpoints, double keep_ms) {
+    auto checkpoint_it = std::upper_bound(checkpoints.begin(), checkpoints.end(), keep_ms,
+        [](double time_ms, const MidiCheckpoint &checkpoint) { return time_ms < checkpoint.time_ms; });
+    if (checkpoint_it == checkpoints.begin() || --checkpoint_it == checkpoints.begin())
+        return;
+    midi_pins.erase(midi_pins.begin(), checkpoint_it->first_pin);
+    checkpoints.erase(checkpoints.begin(), checkpoint_it);
+}
+
+
+// TempoMap methods definition
+TempoMap::TempoMap(double playing_rate) : tempo_segments{ { 0.0, 0.0, playing_rate } } { }
+
+void TempoMap::resetTempo(double timeline_ms, double playing_ms) {
+    double playing_rate = getPlayingRate();
+    tempo_segments.clear();
+    tempo_segments.push_back({ timeline_ms, playing_ms, playing_rate });
+}
+
+void TempoMap::setPlayingRate(double timeline_ms, double playing_rate) {
+    // Segments are kept in timeline order
+    timeline_ms = std::max(timeline_ms, tempo_segments.back().timeline_ms);
+    tempo_segments.push_back({ timeline_ms, getPlayingTime(timeline_ms), playing_rate });
+}
+
+double TempoMap::getPlayingRate() const {
+    return tempo_segments.back().playing_rate;
+}
+
+double TempoMap::getPlayingTime(double timeline_ms) const {
+    // Binary search of the last segment starting at or before timeline_ms
+    auto segment_it = std::upper_bound(tempo_segments.begin(), tempo_segments.end(), timeline_ms,
+        [](double time_ms, const TempoSegment &tempo_segment) { return time_ms < tempo_segment.timeline_ms; });
+    if (segment_it != tempo_segments.begin())
+        --segment_it;
+    return segment_it->playing_ms + (timeline_ms - segment_it->timeline_ms) / segment_it->playing_rate;
+}
+
+double TempoMap::getTimelineTime(double playing_ms) const {
+    auto segment_it = std::upper_bound(tempo_segments.begin(), tempo_segments.end(), playing_ms,
+        [](double time_ms, const TempoSegment &tempo_segment) { return time_ms < tempo_segment.playing_ms; });
+    if (segment_it != tempo_segments.begin())
+        --segment_it;
+    return segment_it->timeline_ms + (playing_ms - segment_it->playing_ms) * segment_it->playing_rate;
+}
+
+
+// StreamFragment methods definition
+StreamFragment::StreamFragment(double offset_ms, unsigned char fragment_at)
+    : offset_ms(offset_ms), fragment_at(fragment_at), appended_at(std::chrono::steady_clock::now()) { }
+
+
+// PlayControl methods definition
+static void deleteFragments(StreamFragment *fragment) {
+    while (fragment != nullptr) {
+        StreamFragment *next_fragment = fragment->next;
+        delete fragment;
+        fragment = next_fragment;
+    }
+}
+
+PlayControl::~PlayControl() {
+    deleteFragments(takeFragments());
+}
+
+std::vector<DeviceSetting> readDeviceSettings(const char* device_settings) {
+    std::vector<DeviceSetting> settings;
+    std::stringstream settings_stream(device_settings);
+    std::string device_setting;
+    while (std::getline(settings_stream, device_setting, ',')) {
+        size_t equal_position = device_setting.rfind('=');
+        if (equal_position == std::string::npos || equal_position == 0)
+            continue;
+        settings.push_back({ device_setting.substr(0, equal_position), std::atof(device_setting.c_str() + equal_position + 1) });
+    }
+    return settings;
+}
+
+void PlayControl::appendFragment(const char* json_str, double offset_ms, unsigned char fragment_at) {
+    appendFragment(reinterpret_cast<const unsigned char*>(json_str), std::strlen(json_str), offset_ms, fragment_at);
+}
+
+void PlayControl::appendFragment(const unsigned char* input_data, size_t input_size, double offset_ms, unsigned char fragment_at) {
+    StreamFragment *fragment = new StreamFragment(offset_ms, fragment_at);
+    fragment->json_str.assign(reinterpret_cast<const char*>(input_data), input_size);
+    pushFragment(fragment);
+}
+
+void PlayControl::appendFragment(std::vector<JsonFile> &&json_files, double offset_ms, unsigned char fragment_at) {
+    StreamFragment *fragment = new StreamFragment(offset_ms, fragment_at);
+    fragment->files_read = true;
+    fragment->json_files = std::move(json_files);
+    pushFragment(fragment);
+}
+
+void PlayControl::appendFragment(const MidiEventsData &events_data, double offset_ms, unsigned char fragment_at) {
+    StreamFragment *fragment = new StreamFragment(offset_ms, fragment_at);
+    fragment->events_read = true;
+    fragment->events.assign(events_data.events, events_data.events + events_data.total_events);
+    for (size_t device_i = 0; device_i < events_data.total_devices; ++device_i)
+        fragment->device_names.push_back(events_data.device_names != nullptr && events_data.device_names[device_i] != nullptr
+            ? events_data.device_names[device_i] : "");
+    if (events_data.sysex_data != nullptr)
+        fragment->sysex_data.assign(events_data.sysex_data, events_data.sysex_data + events_data.sysex_size);
+    pushFragment(fragment);
+}
+
+void PlayControl::pushFragment(StreamFragment *fragment) {
+    fragment->next = stream_fragments.load(std::memory_order_relaxed);
+    while (!stream_fragments.compare_exchange_weak(fragment->next, fragment,
+            std::memory_order_release, std::memory_order_relaxed)) { }
+}
+
+void PlayControl::flushPlaying() {
+    deleteFragments(takeFragments());
+    // Counted after the fragments are taken, so that the ones being processed already are dropped too
+    flushed_playing.fetch_add(1);
 }
 
+StreamFragment *PlayControl::takeFragments() {
+    StreamFragment *fragment = stream_fragments.exchange(nullptr, std::memory_order_acquire);
+    // Reverses the stack so that the fragments are processed in the appended order
+    StreamFragment *oldest_fragment = nullptr;
+    while (fragment != nullptr) {
+        StreamFragment *next_fragment = fragment->next;
+        fragment->next = oldest_fragment;
+        oldest_fragment = fragment;
+        fragment = next_fragment;
+    }
+    return oldest_fragment;
+}
 
 
 // Function to set real-time scheduling
@@ -76,6 +714,48 @@ void setRealTimeScheduling() {
 #endif
 }
 
+// Function to set back the normal scheduling, for threads that shall never preempt the playing one
+void setNormalScheduling() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+#else
+    struct sched_param param;
+    param.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+#endif
+}
+
+bool setThreadAffinity(int cpu) {
+    if (cpu < 0)
+        return false;
+#ifdef _WIN32
+    return cpu < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    return false;   // No thread affinity, like on macOS
+#endif
+}
+
+int getLastCpu() {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+        for (int cpu = CPU_SETSIZE - 1; cpu >= 0; --cpu) {
+            if (CPU_ISSET(cpu, &cpu_set))
+                return cpu;
+        }
+    }
+#endif
+    return std::max(1u, std::thread::hardware_concurrency()) - 1;
+}
+
 
 double get_time_ms(int minutes_numerator, int minutes_denominator) {
 
@@ -85,492 +765,1380 @@ double get_time_ms(int minutes_numerator, int minutes_denominator) {
 }
 
 
-int PlayList(const char* json_str, bool verbose) {
-    
-    disableBackgroundThrottling();
+unsigned char getInputFormat(const unsigned char* input_data, size_t input_size, const char* filename) {
+    const char *extension = filename != nullptr ? std::strrchr(filename, '.') : nullptr;
+    if (extension != nullptr) {
+        std::string file_extension(extension + 1);
+        std::transform(file_extension.begin(), file_extension.end(), file_extension.begin(), ::tolower);
+        if (file_extension == "json")
+            return format_json;
+        if (file_extension == "cbor")
+            return format_cbor;
+        if (file_extension == "msgpack" || file_extension == "mpk")
+            return format_msgpack;
+    }
+    if (input_size == 0 || input_data[0] < 0x80)   // Text, like '[' and '{' or white spaces
+        return format_json;
+    if (input_size >= 3 && input_data[0] == 0xD9 && input_data[1] == 0xD9 && input_data[2] == 0xF7)
+        return format_cbor;     // Self described CBOR tag
+    if (input_data[0] >= 0xA0 && input_data[0] <= 0xBF)
+        return format_cbor;     // Map, a string in MessagePack
+    if (input_data[0] >= 0xDC && input_data[0] <= 0xDF)
+        return format_msgpack;  // 16 and 32 bits array or map
+    return format_detect;       // Small arrays and maps have the same first byte in both
+}
 
-    // Set real-time scheduling
-    setRealTimeScheduling();
-    
-    #ifdef DEBUGGING
-    auto debugging_start = std::chrono::high_resolution_clock::now();
-    auto debugging_now = debugging_start;
-    auto debugging_last = debugging_now;
-    long long completion_time_us = 0;
-    #endif
+nlohmann::json parseInputData(const unsigned char* input_data, size_t input_size, unsigned char input_format) {
+    if (input_format == format_detect)
+        input_format = getInputFormat(input_data, input_size);
+    switch (input_format) {
+        case format_cbor:
+            return nlohmann::json::from_cbor(input_data, input_data + input_size);
+        case format_msgpack:
+            return nlohmann::json::from_msgpack(input_data, input_data + input_size);
+        case format_detect:
+            try {
+                return nlohmann::json::from_cbor(input_data, input_data + input_size);
+            } catch (const nlohmann::json::parse_error&) {
+                return nlohmann::json::from_msgpack(input_data, input_data + input_size);
+            }
+        default:
+            return nlohmann::json::parse(input_data, input_data + input_size);
+    }
+}
 
-    struct PlayReporting {
-        size_t json_processing  = 0;    // milliseconds
-        size_t total_generated  = 0;
-        size_t total_validated  = 0;
-        size_t total_incorrect  = 0;
-        size_t total_redundant  = 0;
-        double total_drag       = 0.0;
-        double total_delay      = 0.0;
-        double maximum_delay    = 0.0;
-        double minimum_delay    = 0.0;
-        double average_delay    = 0.0;
-        double sd_delay         = 0.0;
-    };
-    PlayReporting play_reporting;
+MidiDeviceResolver::MidiDeviceResolver(std::vector<MidiDevice> &available_midi_devices, bool verbose)
+    : available_midi_devices(available_midi_devices), verbose(verbose) { }
 
-    
-    if (verbose) std::cout << "JsonMidiPlayer version: " << VERSION << std::endl;
+void MidiDeviceResolver::waitOpenings() {
+    for (auto &port_opening : port_openings) {
+        if (port_opening.valid())
+            port_opening.wait();
+    }
+}
 
-    // Where the playing happens
+MidiDeviceResolver::~MidiDeviceResolver() {
+    finishDiscovery();
+    // The pending port openings are waited for by their futures before the devices go away
+}
+
+void MidiDeviceResolver::discoverDevices() {
+
+    //
+    // Where each Available Device is collected BUT NOT connected
+    //
+
+    try {
+        RtMidiOut midiOut;  // Temporary MidiOut manipulator
+        unsigned int nPorts = midiOut.getPortCount();
+        if (nPorts == 0) {
+            if (verbose) std::cout << "No output Midi devices available.\n";
+            discovery_result = 1;
+            return;
+        }
+        if (verbose) std::cout << "Available output Midi devices:\n";
+        for (unsigned int i = 0; i < nPorts; i++) {
+            std::string portName = midiOut.getPortName(i);
+            if (verbose) std::cout << "\tMidi device #" << i << ": " << portName << std::endl;
+            available_midi_devices.push_back(MidiDevice(portName, i, verbose));   // The object is copied
+        }
+        // The rawmidi and JACK ports come after the RtMidi ones, also with their own names
+        for (RawMidiPort &rawmidi_port : getRawMidiPorts()) {
+            unsigned int device_i = static_cast<unsigned int>(available_midi_devices.size());
+            if (verbose) std::cout << "\tMidi device #" << device_i << ": " << rawmidi_port.name << std::endl;
+            available_midi_devices.push_back(MidiDevice(rawmidi_port.name, device_i, verbose,
+                std::make_shared<RawMidiOut>(rawmidi_port.hw_id)));
+        }
+        for (JackMidiPort &jack_port : getJackMidiPorts()) {
+            unsigned int device_i = static_cast<unsigned int>(available_midi_devices.size());
+            if (verbose) std::cout << "\tMidi device #" << device_i << ": " << jack_port.name << std::endl;
+            available_midi_devices.push_back(MidiDevice(jack_port.name, device_i, verbose,
+                std::make_shared<JackMidiOut>(jack_port.port_name)));
+        }
+        if (available_midi_devices.size() == 0) {
+            if (verbose) std::cout << "\tNo output Midi devices available.\n";
+            discovery_result = 1;
+            return;
+        }
+    } catch (RtMidiError &error) {
+        error.printMessage();
+        discovery_result = EXIT_FAILURE;
+        return;
+    }
+    port_openings.resize(available_midi_devices.size());
+    for (auto &midi_device : available_midi_devices)
+        midi_device.setOutputCpu(output_cpu, pinning_failed);    // Before any port is opened
+
+    if (verbose) std::cout << "Devices connected:    ";
+
+    while (true) {
+        std::vector<std::pair<std::vector<std::string>, bool>> requests;
+        {
+            std::unique_lock<std::mutex> lock(requests_mutex);
+            requests_condition.wait(lock, [this]() { return !requested_names.empty() || discovery_finishing; });
+            requests.swap(requested_names);
+        }
+        if (requests.empty())
+            break;  // Finishing with no requests left
+        for (const auto &request : requests)
+            openRequestedPorts(request.first, request.second);
+    }
+}
+
+void MidiDeviceResolver::openRequestedPorts(const std::vector<std::string> &device_names, bool all_devices) {
+    for (const std::string &device_name : device_names) {
+        for (uint32_t device_id : getMatchingDevices(getNameId(device_name))) {
+            if (!port_openings[device_id].valid() && !available_midi_devices[device_id].hasPortOpen()) {
+                MidiDevice *midi_device = &available_midi_devices[device_id];
+                // Each port on its own thread, so that a slow one doesn't delay the others
+                port_openings[device_id] = std::async(std::launch::async, [midi_device]() { midi_device->openPort(); });
+            }
+            if (!all_devices)
+                return;
+        }
+    }
+}
+
+void MidiDeviceResolver::setOutputCpu(int output_cpu, std::atomic<bool> *pinning_failed) {
+    this->output_cpu = output_cpu;
+    this->pinning_failed = pinning_failed;
+}
+
+void MidiDeviceResolver::startDiscovery() {
+    discovery_thread = std::thread(&MidiDeviceResolver::discoverDevices, this);
+}
+
+int MidiDeviceResolver::finishDiscovery() {
+    if (discovery_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(requests_mutex);
+            discovery_finishing = true;
+        }
+        requests_condition.notify_one();
+        discovery_thread.join();
+    }
+    return discovery_result;
+}
+
+void MidiDeviceResolver::requestNames(const std::vector<std::string> &device_names, bool all_devices) {
+    if (!discovery_thread.joinable())
+        return;     // Resolved once connected instead
     {
-        // Under its own scope in order to disconnect all devices before the stats reporting !
-        std::vector<MidiDevice> available_midi_devices;
-        std::list<MidiPin> midiToProcess;
-        std::list<MidiPin> midiProcessed;
+        std::lock_guard<std::mutex> lock(requests_mutex);
+        requested_names.emplace_back(device_names, all_devices);
+    }
+    requests_condition.notify_one();
+}
 
-        //
-        // Where each Available Device is collected BUT NOT connected
-        //
+uint32_t MidiDeviceResolver::getNameId(const std::string &device_name) {
+    auto name_id = name_ids.find(device_name);
+    if (name_id != name_ids.end())
+        return name_id->second;
+    // The only time this name is matched against the devices names
+    DeviceName interned_name;
+    for (uint32_t device_id = 0; device_id < available_midi_devices.size(); ++device_id) {
+        // The devices with a prefix, like the rawmidi ones, are only matched by the names starting with it
+        const size_t prefix_length = std::strlen(available_midi_devices[device_id].getNamePrefix());
+        if (device_name.compare(0, prefix_length, available_midi_devices[device_id].getNamePrefix()) == 0
+                && available_midi_devices[device_id].getName().find(device_name.c_str() + prefix_length) != std::string::npos)
+            interned_name.matching_devices.push_back(device_id);
+    }
+    device_names.push_back(std::move(interned_name));
+    return name_ids[device_name] = static_cast<uint32_t>(device_names.size() - 1);
+}
 
-        try {
-            RtMidiOut midiOut;  // Temporary MidiOut manipulator
-            unsigned int nPorts = midiOut.getPortCount();
-            if (nPorts == 0) {
-                if (verbose) std::cout << "No output Midi devices available.\n";
-                return 1;
+const std::vector<uint32_t> &MidiDeviceResolver::getMatchingDevices(uint32_t name_id) const {
+    return device_names[name_id].matching_devices;
+}
+
+uint32_t MidiDeviceResolver::connectName(uint32_t name_id) {
+    DeviceName &device_name = device_names[name_id];
+    if (device_name.connected_device == no_device_id) {
+        // A device that doesn't match or doesn't open never makes the next matching ones unavailable
+        for (uint32_t device_id : device_name.matching_devices) {
+            //
+            // Where the Device Port is connected/opened (Main reason for errors)
+            //
+            if (openDevice(device_id)) {
+                device_name.connected_device = device_id;
+                break;
+            }
+        }
+    }
+    return device_name.connected_device;
+}
+
+uint32_t MidiDeviceResolver::connectNames(const std::vector<std::string> &device_names) {
+    for (const std::string &device_name : device_names) {
+        uint32_t device_id = connectName(getNameId(device_name));
+        if (device_id != no_device_id)
+            return device_id;   // For Message devices only the first one found is connected and NOT all of them
+    }
+    return no_device_id;
+}
+
+bool MidiDeviceResolver::openDevice(uint32_t device_id) {
+    if (device_id < port_openings.size() && port_openings[device_id].valid())
+        port_openings[device_id].get();     // Only here the pipeline waits for the port being opened
+    return available_midi_devices[device_id].openPort();
+}
+
+MidiDevice *MidiDeviceResolver::getDevice(uint32_t device_id) {
+    return device_id < available_midi_devices.size() ? &available_midi_devices[device_id] : nullptr;
+}
+
+bool isValidMidiMessage(const unsigned char *midi_message, size_t size) {
+    if (size == 0 || !(midi_message[0] & 0x80))
+        return false;
+    size_t data_bytes = size - 1;
+    switch (midi_message[0] & 0xF0) {
+        case action_note_off:
+        case action_note_on:
+        case action_control_change:
+        case action_key_pressure:
+        case action_pitch_bend:
+            if (data_bytes != 2) return false;
+            break;
+        case action_program_change:
+        case action_channel_pressure:
+            if (data_bytes != 1) return false;
+            break;
+        default:    // action_system
+            switch (midi_message[0]) {
+                case system_sysex_start:
+                    if (size < 3 || midi_message[size - 1] != system_sysex_end) return false;
+                    data_bytes = size - 2;  // The end byte isn't a data byte
+                    break;
+                case system_song_pointer:
+                    if (data_bytes != 2) return false;
+                    break;
+                default:
+                    if (data_bytes != 0) return false;
+                    break;
             }
-            if (verbose) std::cout << "Available output Midi devices:\n";
-            for (unsigned int i = 0; i < nPorts; i++) {
-                std::string portName = midiOut.getPortName(i);
-                if (verbose) std::cout << "\tMidi device #" << i << ": " << portName << std::endl;
-                available_midi_devices.push_back(MidiDevice(portName, i, verbose));   // The object is copied
+            break;
+    }
+    for (size_t byte_i = 1; byte_i <= data_bytes; ++byte_i) {
+        if (midi_message[byte_i] & 0x80)
+            return false;
+    }
+    return true;
+}
+
+// Sorting priority of a message at the same time, 0x00 for a message that isn't valid
+unsigned char getMessagePriority(const std::vector<unsigned char> &midi_message) {
+    return getMessagePriority(midi_message.data(), midi_message.size());
+}
+
+unsigned char getMessagePriority(const unsigned char *midi_message, size_t size) {
+
+    if (size == 0)
+        return 0x00;    // Not a valid message, no priority given
+    unsigned char status_byte = midi_message[0];
+    unsigned char message_action = status_byte & 0xF0;
+    // The channel messages without all their data bytes aren't read any further
+    if (message_action != action_system
+            && size < (message_action == action_program_change || message_action == action_channel_pressure ? 2u : 3u))
+        return 0x00;
+
+    switch (message_action) {
+        case action_system:
+            switch (status_byte) {
+                case system_timing_clock:
+                    // Any clock message falls here
+                    return 0x01;       // Top priority 0.1
+                case system_clock_start:
+                case system_clock_continue:
+                    // Any clock message falls here
+                    return 0x31;       // High priority 3.1
+                case system_clock_stop:
+                    // Any clock message falls here
+                    return 0xB0;       // Low priority 11.0
+                case system_song_pointer:
+                    if (size < 3)
+                        return 0x00;    // Without its position
+                    return 0xB1;       // Low priority 11.1
+                case system_sysex_start:
+                    if (size < 2 || midi_message[size - 1] != system_sysex_end)
+                        return 0x00;    // Not terminated
+                    return 0xF0 | status_byte & 0x0F;       // Lowest priority 15
+                default:
+                    // All other messages get a low priority
+                    return 0xD0 | status_byte & 0x0F;       // Low priority 13
             }
-            if (available_midi_devices.size() == 0) {
-                if (verbose) std::cout << "\tNo output Midi devices available.\n";
-                return 1;
+        case action_note_off:
+            return 0x40 | status_byte & 0x0F;       // Normal priority 4 for Off
+        case action_note_on:
+            return 0x50 | status_byte & 0x0F;       // Normal priority 5 for On
+        case action_control_change:
+            if (midi_message[1] == 1) {             // Modulation
+                return 0x60 | status_byte & 0x0F;           // Low priority 6
+            } else if (midi_message[1] == 0 || midi_message[1] == 32) {
+                // 0 -  Bank Select (MSB)
+                // 32 - Bank Select (LSB)
+                return 0x10;                                // High priority 1.0	(Equivalent to Program Change)
+            } else if (midi_message[1] == 123) {
+                // 123 - All notes off (0x7B)
+                // shall come after Notes On and Off
+                return 0x90 | status_byte & 0x0F;           // Low priority 9
+            } else {
+                return 0x20 | status_byte & 0x0F;           // High priority 2
             }
-        } catch (RtMidiError &error) {
-            error.printMessage();
-            return EXIT_FAILURE;
-        }
+        case action_pitch_bend:
+            return 0x70 | status_byte & 0x0F;           // Low priority 7
+        case action_key_pressure:
+            return 0x80 | status_byte & 0x0F;           // Low priority 8
+        case action_program_change:
+            return 0x11;                            // High priority 1.1
+        case action_channel_pressure:
+            return 0x80 | status_byte & 0x0F;       // Low priority 8
+        default:
+            return 0x00;    // Not a valid message, no priority given
+    }
+}
 
-        #ifdef DEBUGGING
-        debugging_now = std::chrono::high_resolution_clock::now();
-        auto completion_time = std::chrono::duration_cast<std::chrono::microseconds>(debugging_now - debugging_last);
-        completion_time_us = completion_time.count();
-        std::cout << "MIDI DEVICES FULLY PROCESSED IN: " << completion_time_us << " microseconds" << std::endl;
-        debugging_last = std::chrono::high_resolution_clock::now();
-        #endif
 
-        //
-        // Where the JSON content is processed and added up the Pluck midi messages
-        //
+// Clock pulses for the clocked devices and MMC Play and Stop for the controlled ones, shifted by offset_ms
+void addClockPins(const JsonClock &json_clock, MidiDeviceResolver &device_resolver,
+                    std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, double offset_ms) {
 
-        if (verbose) std::cout << "Devices connected:    ";
+    const unsigned int total_clock_pulses = json_clock.total_clock_pulses;
+    const unsigned int pulse_duration_min_numerator = json_clock.pulse_duration_min_numerator;
+    const unsigned int pulse_duration_min_denominator = json_clock.pulse_duration_min_denominator;
+    auto last_position_ms = offset_ms + get_time_ms(total_clock_pulses * pulse_duration_min_numerator, pulse_duration_min_denominator);
 
-        auto data_processing_start = std::chrono::high_resolution_clock::now();
+    if (total_clock_pulses > 0 && pulse_duration_min_numerator > 0 && pulse_duration_min_denominator > 0) {
 
-        try {
+        std::unordered_set<uint32_t> clocked_devices;
 
-            nlohmann::json json_files_data = nlohmann::json::parse(json_str);
+        // Unlike the "devices" lists, all the devices matching each name are clocked
+        for (const std::string &device_name : json_clock.clocked_devices) {
 
-            for (nlohmann::json jsonData : json_files_data) {
+            for (uint32_t device_id : device_resolver.getMatchingDevices(device_resolver.getNameId(device_name))) {
 
-                nlohmann::json jsonFileType;
-                nlohmann::json jsonFileUrl;
-                nlohmann::json jsonFilePlaylist;
+                MidiDevice *clocked_device = device_resolver.getDevice(device_id);
+                //
+                // Where the Device Port is connected/opened (Main reason for errors)
+                //
+                if (!device_resolver.openDevice(device_id) || !clocked_devices.insert(device_id).second)
+                    continue;   // Not available or already clocked!
 
-                try
-                {
-                    jsonFileType = jsonData["filetype"];
-                    jsonFileUrl = jsonData["url"];
-                    jsonFilePlaylist = jsonData["content"];
-                }
-                catch (nlohmann::json::parse_error& ex)
-                {
-                    if (verbose) std::cerr << "Unable to extract json data: " << ex.byte << std::endl;
-                    continue;
-                }
-                
-                if (jsonFileType != FILE_TYPE || jsonFileUrl != FILE_URL) {
-                    if (verbose) std::cerr << "Wrong type of file!" << std::endl;
-                    continue;
+                // High Priority 3.1
+                midiToProcess.push_back( MidiPin(offset_ms, clocked_device, { system_clock_start }, 0x31) );
+                play_reporting.total_generated++;
+
+                for (unsigned int pulse_i = 1; pulse_i < total_clock_pulses; ++pulse_i) {
+
+                    midiToProcess.push_back(MidiPin(
+                        offset_ms + get_time_ms(pulse_i * pulse_duration_min_numerator, pulse_duration_min_denominator),
+                        clocked_device,
+                        { system_timing_clock },
+                        0x01    // Top Priority 0.1
+                    ));
+                    play_reporting.total_generated++;
                 }
 
-                // Dictionary where the key is a JSON list
-                std::unordered_map<std::string, MidiDevice*> connected_devices_by_name;
-                std::unordered_set<std::string> unavailable_devices;
-                
-                // Check if jsonFileContent is a non-empty array
-                if (jsonFilePlaylist.is_array() && !jsonFilePlaylist.empty()) {
+                // Lowest priority 11.0
+                midiToProcess.push_back(MidiPin(last_position_ms, clocked_device, { system_clock_stop }, 0xB0));
+                play_reporting.total_generated++;
 
-					// Keeps the last called device in the JsonMidiPlayer file
-					MidiDevice *last_called_midi_device = nullptr;
-                    // Just the declarations, no need to set them
-                    unsigned char data_byte_1;
-                    unsigned char data_byte_2;
-					unsigned char priority;
+                // Lowest priority 11.1
+                midiToProcess.push_back(MidiPin(last_position_ms, clocked_device, { system_song_pointer, 0, 0 }, 0xB1));
+                play_reporting.total_generated++;
+            }
+        }
 
-					for (auto jsonPlaylistItem : jsonFilePlaylist)
-					{
-						// Most of the time it's a midi_message being processed, so it makes sense to be the first to check
-						if (jsonPlaylistItem.contains("midi_message")) {
+        std::unordered_set<uint32_t> controlled_devices;
+
+        for (const std::string &device_name : json_clock.controlled_devices) {
+
+            for (uint32_t device_id : device_resolver.getMatchingDevices(device_resolver.getNameId(device_name))) {
+
+                MidiDevice *controlled_device = device_resolver.getDevice(device_id);
+                if (!device_resolver.openDevice(device_id) || !controlled_devices.insert(device_id).second)
+                    continue;   // Not available or already controlled!
+
+                // Action           MMC SysEx
+                // Stop             F0 7F 7F 06 01 F7
+                // Play             F0 7F 7F 06 02 F7
+                // Deferred Play    F0 7F 7F 06 03 F7
+                // Fast Forward     F0 7F 7F 06 04 F7
+                // Rewind           F0 7F 7F 06 05 F7
+                // Record Strobe    F0 7F 7F 06 06 F7
+                // Record Exit      F0 7F 7F 06 07 F7
+                // Pause            F0 7F 7F 06 09 F7
+                // Locate           F0 7F 7F 06 44 … F7
+
+                // MMC - Play
+                midiToProcess.push_back(MidiPin(
+                    offset_ms,
+                    controlled_device,
+                    { system_sysex_start, 0x7F, 0x7F, 0x06, 0x02, system_sysex_end },
+                    0x30    // High priority 3.0
+                ));
+                play_reporting.total_generated++;
+
+                // MMC - Stop
+                midiToProcess.push_back(MidiPin(
+                    last_position_ms,
+                    controlled_device,
+                    { system_sysex_start, 0x7F, 0x7F, 0x06, 0x01, system_sysex_end },
+                    0xF1    // Lowest priority 16.1
+                ));
+                play_reporting.total_generated++;
+
+                // MMC - Rewind
+                midiToProcess.push_back(MidiPin(
+                    last_position_ms,
+                    controlled_device,
+                    { system_sysex_start, 0x7F, 0x7F, 0x06, 0x05, system_sysex_end },
+                    0xF2    // Lowest priority 16.2
+                ));
+                play_reporting.total_generated++;
+            }
+        }
+    }
+}
 
-							if (last_called_midi_device != nullptr) {
 
-								play_reporting.total_incorrect++;
+// Rows of the compact encoding, [time_ms, status_byte, data_byte_1, data_byte_2] with as many data bytes as
+// the message has, and [time_ms, 240, [data_bytes]] for SysEx, read by position without any key lookup
+static void processJsonRows(const nlohmann::json &json_rows, MidiDevice *midi_device,
+                                std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, double offset_ms) {
 
-								// Create an API with the default API
-								try
-								{
-								    double time_milliseconds = jsonPlaylistItem["time_ms"];
-									if (time_milliseconds < 0) {
+    std::vector<unsigned char> json_midi_message;
+    for (const nlohmann::json &json_row : json_rows) {
 
-										continue;
-										
-									} else {
-
-										unsigned char status_byte = jsonPlaylistItem["midi_message"]["status_byte"];
-										std::vector<unsigned char> json_midi_message = { status_byte }; // Starts the json_midi_message to a new Status Byte
-										
-										unsigned char message_action = status_byte & 0xF0;
-
-                                        // Where the Midi message is set
-										switch (message_action) {
-											case action_system:
-												switch (status_byte) {
-													case system_song_pointer:
-													{
-														// This is already a try catch situation
-														data_byte_1 = jsonPlaylistItem["midi_message"]["data_byte_1"];
-														data_byte_2 = jsonPlaylistItem["midi_message"]["data_byte_2"];
-														if (data_byte_1 & 128 | data_byte_2 & 128)  // Makes sure it's inside the processing window
-															continue;
-														json_midi_message.push_back(data_byte_1);
-														json_midi_message.push_back(data_byte_2);
-														break;
-													}
-													case system_sysex_start:
-													{
-														// sysex_data_bytes = jsonElement["midi_message"]["data_bytes"].get<std::vector<unsigned char>>();
-														
-														nlohmann::json data_bytes = jsonPlaylistItem["midi_message"]["data_bytes"];
-														for (unsigned char sysex_data_byte : data_bytes) {
-															// Makes sure it's SysEx valid data
-															if (sysex_data_byte != 0xF0 && sysex_data_byte != 0xF7) {
-																json_midi_message.push_back(sysex_data_byte);
-															} else {
-																continue;
-															}
-														}
-														if (json_midi_message.size() < 2)
-															continue;
-														json_midi_message.push_back(0xF7);  // End SysEx Data Byte
-														break;
-													}
-													default:
-														break;
-												}
-												break;
-											case action_note_off:
-											case action_note_on:
-											case action_control_change:
-											case action_pitch_bend:
-											case action_key_pressure:
-											{
-												// This is already a try catch situation
-												data_byte_1 = jsonPlaylistItem["midi_message"]["data_byte_1"];
-												data_byte_2 = jsonPlaylistItem["midi_message"]["data_byte_2"];
-												if (data_byte_1 & 128 | data_byte_2 & 128)
-													continue;
-												json_midi_message.push_back(data_byte_1);
-												json_midi_message.push_back(data_byte_2);
-												break;
-											}
-											case action_program_change:
-											case action_channel_pressure:
-											{
-												data_byte_1 = jsonPlaylistItem["midi_message"]["data_byte"];
-												if (data_byte_1 & 128)
-													continue;
-												json_midi_message.push_back(data_byte_1);
-												break;
-											}
-											default:
-												break;
-										}
+        play_reporting.total_incorrect++;
+
+        if (midi_device == nullptr || !json_row.is_array() || json_row.size() < 2
+                || !json_row[0].is_number() || !json_row[1].is_number_unsigned())
+            continue;
+        const double time_milliseconds = json_row[0].get<double>();
+        const uint64_t status_byte = json_row[1].get<uint64_t>();
+        if (time_milliseconds < 0 || status_byte > 0xFF)
+            continue;
+
+        json_midi_message.assign(1, static_cast<unsigned char>(status_byte));
+        const nlohmann::json &data_bytes = status_byte == system_sysex_start && json_row.size() == 3 ? json_row[2] : json_row;
+        bool valid_bytes = data_bytes.is_array();
+        for (size_t byte_i = &data_bytes == &json_row ? 2 : 0; valid_bytes && byte_i < data_bytes.size(); ++byte_i) {
+            valid_bytes = data_bytes[byte_i].is_number_unsigned() && data_bytes[byte_i].get<uint64_t>() < 0x80;
+            if (valid_bytes)
+                json_midi_message.push_back(static_cast<unsigned char>(data_bytes[byte_i].get<uint64_t>()));
+        }
+        if (status_byte == system_sysex_start)
+            json_midi_message.push_back(system_sysex_end);
+        if (!valid_bytes || !isValidMidiMessage(json_midi_message.data(), json_midi_message.size()))
+            continue;
+        unsigned char priority = getMessagePriority(json_midi_message);
+        if (priority == 0x00)
+            continue;
+
+        midiToProcess.push_back( MidiPin(offset_ms + time_milliseconds, midi_device, json_midi_message, priority) );
+        play_reporting.total_incorrect--;    // Cancels out the initial ++ increase at the beginning of the loop
+        play_reporting.total_validated++;
+    }
+}
+
+// Adds the pins of a single Json Midi Player file, with its times shifted by offset_ms
+void processJsonData(nlohmann::json &jsonData, MidiDeviceResolver &device_resolver,
+                        std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, bool verbose, double offset_ms) {
+
+    nlohmann::json jsonFileType;
+    nlohmann::json jsonFileUrl;
+    nlohmann::json jsonFilePlaylist;
+
+    try
+    {
+        jsonFileType = jsonData["filetype"];
+        jsonFileUrl = jsonData["url"];
+        jsonFilePlaylist = jsonData["content"];
+    }
+    catch (nlohmann::json::parse_error& ex)
+    {
+        if (verbose) std::cerr << "Unable to extract json data: " << ex.byte << std::endl;
+        return;
+    }
+    
+    if (jsonFileType != FILE_TYPE || jsonFileUrl != FILE_URL) {
+        if (verbose) std::cerr << "Wrong type of file!" << std::endl;
+        return;
+    }
+
+    // The compact encoding has its devices given upfront, each block of rows refers to one of them by its index
+    const bool rows_encoding = jsonData.contains("encoding") && jsonData["encoding"] == "rows";
+    if (jsonData.contains("encoding") && !rows_encoding) {
+        if (verbose) std::cerr << "Unknown encoding: " << jsonData["encoding"] << std::endl;
+        return;
+    }
+    std::vector<MidiDevice*> rows_devices;
+    if (rows_encoding && jsonData.contains("devices")) {
+        try {
+            for (const nlohmann::json &json_device_names : jsonData["devices"]) {
+                std::vector<std::string> device_names;
+                for (const std::string device_name : json_device_names)
+                    device_names.push_back(device_name);
+                rows_devices.push_back(device_resolver.getDevice(device_resolver.connectNames(device_names)));
+            }
+        } catch (const nlohmann::json::exception& e) {
+            if (verbose) std::cerr << "JSON error: " << e.what() << std::endl;
+        }
+    }
 
-                                        // Where the Priority is set
-										switch (message_action) {
-											case action_system:
-												switch (status_byte) {
-													case system_timing_clock:
-														// Any clock message falls here
-														priority = 0x01;       // Top priority 0.1
-														break;
-													case system_clock_start:
-													case system_clock_continue:
-														// Any clock message falls here
-														priority = 0x31;       // High priority 3.1
-														break;
-													case system_clock_stop:
-														// Any clock message falls here
-														priority = 0xB0;       // Low priority 11.0
-														break;
-													case system_song_pointer:
-														priority = 0xB1;       // Low priority 11.1
-														break;
-													case system_sysex_start:
-														priority = 0xF0 | status_byte & 0x0F;       // Lowest priority 15
-														break;
-													default:
-														// All other messages get a low priority
-														priority = 0xD0 | status_byte & 0x0F;       // Low priority 13
-														break;
+    // Check if jsonFileContent is a non-empty array
+    if (jsonFilePlaylist.is_array() && !jsonFilePlaylist.empty()) {
+
+		// Keeps the last called device in the JsonMidiPlayer file
+		MidiDevice *last_called_midi_device = nullptr;
+        // Just the declarations, no need to set them
+        unsigned char data_byte_1;
+        unsigned char data_byte_2;
+		unsigned char priority;
+
+		for (auto &jsonPlaylistItem : jsonFilePlaylist)
+		{
+			// In the compact encoding most items are blocks of rows instead
+			if (rows_encoding && jsonPlaylistItem.contains("rows")) {
+
+				const nlohmann::json &json_device_index = jsonPlaylistItem["device"];
+				MidiDevice *rows_device = json_device_index.is_number_unsigned() && json_device_index.get<size_t>() < rows_devices.size()
+					? rows_devices[json_device_index.get<size_t>()] : nullptr;
+				processJsonRows(jsonPlaylistItem["rows"], rows_device, midiToProcess, play_reporting, offset_ms);
+
+			// Most of the time it's a midi_message being processed, so it makes sense to be the first to check
+			} else if (jsonPlaylistItem.contains("midi_message")) {
+
+				if (last_called_midi_device != nullptr) {
+
+					play_reporting.total_incorrect++;
+
+					// Create an API with the default API
+					try
+					{
+					    double time_milliseconds = jsonPlaylistItem["time_ms"];
+						if (time_milliseconds < 0) {
+
+							continue;
+							
+						} else {
+
+							unsigned char status_byte = jsonPlaylistItem["midi_message"]["status_byte"];
+							std::vector<unsigned char> json_midi_message = { status_byte }; // Starts the json_midi_message to a new Status Byte
+							
+							unsigned char message_action = status_byte & 0xF0;
+
+                            // Where the Midi message is set
+							switch (message_action) {
+								case action_system:
+									switch (status_byte) {
+										case system_song_pointer:
+										{
+											// This is already a try catch situation
+											data_byte_1 = jsonPlaylistItem["midi_message"]["data_byte_1"];
+											data_byte_2 = jsonPlaylistItem["midi_message"]["data_byte_2"];
+											if (data_byte_1 & 128 | data_byte_2 & 128)  // Makes sure it's inside the processing window
+												continue;
+											json_midi_message.push_back(data_byte_1);
+											json_midi_message.push_back(data_byte_2);
+											break;
+										}
+										case system_sysex_start:
+										{
+											// sysex_data_bytes = jsonElement["midi_message"]["data_bytes"].get<std::vector<unsigned char>>();
+											
+											nlohmann::json data_bytes = jsonPlaylistItem["midi_message"]["data_bytes"];
+											for (unsigned char sysex_data_byte : data_bytes) {
+												// Makes sure it's SysEx valid data
+												if (sysex_data_byte != 0xF0 && sysex_data_byte != 0xF7) {
+													json_midi_message.push_back(sysex_data_byte);
+												} else {
+													continue;
 												}
-												break;
-											case action_note_off:
-                                                priority = 0x40 | status_byte & 0x0F;       // Normal priority 4 for Off
-                                                break;
-											case action_note_on:
-                                                priority = 0x50 | status_byte & 0x0F;       // Normal priority 5 for On
-                                                break;
-											case action_control_change:
-                                                if (data_byte_1 == 1) {             // Modulation
-                                                    priority = 0x60 | status_byte & 0x0F;       // Low priority 6
-                                                } else if (data_byte_1 == 0 || data_byte_1 == 32) {
-                                                    // 0 -  Bank Select (MSB)
-                                                    // 32 - Bank Select (LSB)
-                                                    priority = 0x10;                            // High priority 1.0	(Equivalent to Program Change)
-                                                } else if (data_byte_1 == 123) {
-                                                    // 123 - All notes off (0x7B)
-                                                    // shall come after Notes On and Off
-                                                    priority = 0x90 | status_byte & 0x0F;       // Low priority 9
-                                                } else {
-                                                    priority = 0x20 | status_byte & 0x0F;       // High priority 2
-                                                }
-                                                break;
-											case action_pitch_bend:
-                                                priority = 0x70 | status_byte & 0x0F;           // Low priority 7
-                                                break;
-											case action_key_pressure:
-                                                priority = 0x80 | status_byte & 0x0F;           // Low priority 8
-                                                break;
-											case action_program_change:
-                                                priority = 0x11;                            // High priority 1.1
-                                                break;
-											case action_channel_pressure:
-                                                priority = 0x80 | status_byte & 0x0F;       // Low priority 8
-                                                break;
-											default:
-												continue;   // Not a valid message, no priority given, jumps to the next one
+											}
+											if (json_midi_message.size() < 2)
+												continue;
+											json_midi_message.push_back(0xF7);  // End SysEx Data Byte
+											break;
 										}
-
-										midiToProcess.push_back( MidiPin(time_milliseconds, last_called_midi_device, json_midi_message, priority) );
-										play_reporting.total_incorrect--;    // Cancels out the initial ++ increase at the beginning of the loop
-										play_reporting.total_validated++;
+										default:
+											break;
 									}
+									break;
+								case action_note_off:
+								case action_note_on:
+								case action_control_change:
+								case action_pitch_bend:
+								case action_key_pressure:
+								{
+									// This is already a try catch situation
+									data_byte_1 = jsonPlaylistItem["midi_message"]["data_byte_1"];
+									data_byte_2 = jsonPlaylistItem["midi_message"]["data_byte_2"];
+									if (data_byte_1 & 128 | data_byte_2 & 128)
+										continue;
+									json_midi_message.push_back(data_byte_1);
+									json_midi_message.push_back(data_byte_2);
+									break;
 								}
-								catch (const nlohmann::json::exception& e) {
-									if (verbose) std::cerr << "JSON error: " << e.what() << std::endl;
-									continue;
-								} catch (const std::exception& e) {
-									if (verbose) std::cerr << "Error: " << e.what() << std::endl;
-									continue;
-								} catch (...) {
-									if (verbose) std::cerr << "Unknown error occurred." << std::endl;
-									continue;
+								case action_program_change:
+								case action_channel_pressure:
+								{
+									data_byte_1 = jsonPlaylistItem["midi_message"]["data_byte"];
+									if (data_byte_1 & 128)
+										continue;
+									json_midi_message.push_back(data_byte_1);
+									break;
 								}
+								default:
+									break;
 							}
 
-						// Where the last device is set based on the json "device" input
-						} else if (jsonPlaylistItem.contains("devices")) {
+                            // Where the Priority is set
+							priority = getMessagePriority(json_midi_message);
+							if (priority == 0x00)
+								continue;   // Not a valid message, no priority given, jumps to the next one
+
+							midiToProcess.push_back( MidiPin(offset_ms + time_milliseconds, last_called_midi_device, json_midi_message, priority) );
+							play_reporting.total_incorrect--;    // Cancels out the initial ++ increase at the beginning of the loop
+							play_reporting.total_validated++;
+						}
+					}
+					catch (const nlohmann::json::exception& e) {
+						if (verbose) std::cerr << "JSON error: " << e.what() << std::endl;
+						continue;
+					} catch (const std::exception& e) {
+						if (verbose) std::cerr << "Error: " << e.what() << std::endl;
+						continue;
+					} catch (...) {
+						if (verbose) std::cerr << "Unknown error occurred." << std::endl;
+						continue;
+					}
+				}
+
+			// Where the last device is set based on the json "device" input
+			} else if (jsonPlaylistItem.contains("devices")) {
+
+				// It's a list of Devices that is given as Device
+				std::vector<std::string> device_names;
+				for (std::string device_name : jsonPlaylistItem["devices"])
+					device_names.push_back(device_name);
+				last_called_midi_device = device_resolver.getDevice(device_resolver.connectNames(device_names));
+
+			// Where the clock is processed
+			} else if (jsonPlaylistItem.contains("clock")) {
+
+				try
+				{
+					// Access the value associated with the key "clock"
+					auto clockValue = jsonPlaylistItem.at("clock");	// Same as jsonElement["clock"]
+					JsonClock json_clock;
+					json_clock.total_clock_pulses = clockValue["total_clock_pulses"];
+					json_clock.pulse_duration_min_numerator = clockValue["pulse_duration_min_numerator"];
+					json_clock.pulse_duration_min_denominator = clockValue["pulse_duration_min_denominator"];
+					// The devices JSON list key
+					for (std::string device_name : clockValue["clocked_devices"])
+						json_clock.clocked_devices.push_back(device_name);
+					for (std::string device_name : clockValue["controlled_devices"])
+						json_clock.controlled_devices.push_back(device_name);
+					addClockPins(json_clock, device_resolver, midiToProcess, play_reporting, offset_ms);
+				} catch (const std::exception& e) {
+					if (verbose) std::cerr << "Error: " << e.what() << std::endl;
+				}
+
+			}
+		}
+
+    } else {
+        if (verbose) std::cout << "JSON file is empty." << std::endl;
+    }
+
+}
+
+
+// Adds the pins of the binary input events, with their times shifted by offset_ms
+void processMidiEvents(const MidiEventsData &events_data, MidiDeviceResolver &device_resolver,
+                        std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, double offset_ms) {
+
+    if (events_data.device_names == nullptr && events_data.total_devices > 0)
+        return;     // Rejected up front by the callers, no names to index by the events devices
+
+    // Each device name is connected only once
+    std::vector<MidiDevice*> midi_devices(events_data.total_devices, nullptr);
+    for (size_t device_i = 0; device_i < events_data.total_devices; ++device_i) {
+        if (events_data.device_names[device_i] != nullptr)
+            midi_devices[device_i] = device_resolver.getDevice(device_resolver.connectName(device_resolver.getNameId(events_data.device_names[device_i])));
+    }
+
+    for (size_t event_i = 0; event_i < events_data.total_events; ++event_i) {
+
+        const MidiEventRecord &midi_event = events_data.events[event_i];
+        play_reporting.total_incorrect++;
+
+        if (!std::isfinite(midi_event.time_ms) || midi_event.time_ms < 0 || midi_event.device >= events_data.total_devices || midi_devices[midi_event.device] == nullptr)
+            continue;
+
+        std::vector<unsigned char> midi_message;
+        if (midi_event.status_byte == system_sysex_start) {
+            if (midi_event.sysex_offset >= events_data.sysex_size
+                    || events_data.sysex_data[midi_event.sysex_offset] != system_sysex_start)
+                continue;
+            const unsigned char *sysex_start = events_data.sysex_data + midi_event.sysex_offset;
+            const void *sysex_end = std::memchr(sysex_start, system_sysex_end, events_data.sysex_size - midi_event.sysex_offset);
+            if (sysex_end == nullptr)
+                continue;
+            midi_message.assign(sysex_start, static_cast<const unsigned char*>(sysex_end) + 1);
+        } else {
+            midi_message = { midi_event.status_byte, midi_event.data_byte_1, midi_event.data_byte_2 };
+            switch (midi_event.status_byte & 0xF0) {
+                case action_program_change:
+                case action_channel_pressure:
+                    midi_message.resize(2);
+                    break;
+                case action_system:
+                    if (midi_event.status_byte != system_song_pointer)
+                        midi_message.resize(1);
+                    break;
+            }
+        }
+        if (!isValidMidiMessage(midi_message.data(), midi_message.size()))
+            continue;
+        unsigned char priority = getMessagePriority(midi_message);
+        if (priority == 0x00)
+            continue;
+
+        midiToProcess.push_back( MidiPin(offset_ms + midi_event.time_ms, midi_devices[midi_event.device], midi_message, priority) );
+        play_reporting.total_incorrect--;    // Cancels out the initial ++ increase at the beginning of the loop
+        play_reporting.total_validated++;
+    }
+}
+
+
+// Sorts and cleans up the redundant pins, releasing the notes and stopping the clocks at the end
+void processMidiPins(std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting) {
+
+    if (midiToProcess.size() == 0)
+        return;
+
+    // The last pins of each device, only valid during this clean up pass
+    std::unordered_map<MidiDevice*, MidiTracking> devices_tracking;
+
+    // Two levels sorting criteria
+    midiToProcess.sort([]( const MidiPin &a, const MidiPin &b ) {
+        
+        // Time is the primary sorting criteria
+        if (a.getTime() != b.getTime())  
+            return a.getTime() < b.getTime();           // Primary: Sort by time (ascending)
+    
+        // Then sort by Priority (Ascendent)
+        // Must be "<" instead of "<=" due to the mysterious "strict weak ordering"
+        // Explanation here: https://youtu.be/fi0CQ7laiXE?si=fysJC-UdG2lJytjU&t=1542
+        return a.getPriority() < b.getPriority();      // Secondary: Sort by priority (ascending)
+        
+    });
+
+    //
+    // Where the redundant Midi messages lists are Cleaned up and processed
+    //
+
+    // Loop through the list and remove elements
+    for (auto pin_it = midiToProcess.begin(); pin_it != midiToProcess.end(); ) {
+
+        // Auxiliary variables
+        MidiPin &pluck_pin = *pin_it;	// Just an handy conversion
+        MidiTracking &pluck_tracking = devices_tracking[pluck_pin.getDevice()];
+
+        switch (pluck_pin.getAction()) {
+            case action_system:
+                switch (pluck_pin.getStatusByte()) {
+                    case system_timing_clock:
+                        if (pluck_tracking.last_pin_clock != nullptr) {
+                            if (pluck_tracking.last_pin_clock->getTime() == pluck_pin.getTime()) {
+                                if (pluck_tracking.last_pin_clock->getStatusByte() == system_clock_stop) {      // Clock Stop
+                                    pluck_tracking.last_pin_clock->setStatusByte(system_timing_clock);
+                                }
+                                ++(play_reporting.total_redundant);
+                                pin_it = midiToProcess.erase(pin_it);
+                                goto skip_to_next_pin;
+                            } else if (pluck_tracking.last_pin_clock->getStatusByte() == system_clock_stop) {   // Clock Stop
+                                pluck_pin.setStatusByte(system_clock_continue);
+                            }
+                        } else {
+                            pluck_pin.setStatusByte(system_clock_start);
+                        }
+                        pluck_tracking.last_pin_clock = &pluck_pin;
+                        ++pin_it; // Only increment if no removal
+                    break;
+                    case system_clock_start:
+                        if (pluck_tracking.last_pin_clock != nullptr) {
+                            if (pluck_tracking.last_pin_clock->getTime() == pluck_pin.getTime()) {
+                                if (pluck_tracking.last_pin_clock->getStatusByte() == system_clock_stop) {      // Clock Stop
+                                    pluck_tracking.last_pin_clock->setStatusByte(system_timing_clock);
+                                }
+                                ++(play_reporting.total_redundant);
+                                pin_it = midiToProcess.erase(pin_it);
+                                goto skip_to_next_pin;
+                            } else if (pluck_tracking.last_pin_clock->getStatusByte() == system_clock_stop) {   // Clock Stop
+                                pluck_pin.setStatusByte(system_clock_continue);
+                            } else {
+                                pluck_pin.setStatusByte(system_timing_clock);
+                            }
+                        }
+                        pluck_tracking.last_pin_clock = &pluck_pin;
+                        ++pin_it; // Only increment if no removal
+                    break;
+                    case system_clock_stop:
+                        if (pluck_tracking.last_pin_clock != nullptr) {
+                            if (pluck_tracking.last_pin_clock->getTime() == pluck_pin.getTime()) {
+                                pluck_tracking.last_pin_clock->setStatusByte(system_clock_stop);
+                                ++(play_reporting.total_redundant);
+                                pin_it = midiToProcess.erase(pin_it);
+                                goto skip_to_next_pin;
+                            } else if (pluck_tracking.last_pin_clock->getStatusByte() == system_clock_stop) {   // Clock Stop
+                                ++(play_reporting.total_redundant);
+                                pin_it = midiToProcess.erase(pin_it);
+                                goto skip_to_next_pin;
+                            }
+                        }
+                        pluck_tracking.last_pin_clock = &pluck_pin;
+                        ++pin_it; // Only increment if no removal
+                    break;
+                    case system_clock_continue:
+                        if (pluck_tracking.last_pin_clock != nullptr) {
+                            if (pluck_tracking.last_pin_clock->getTime() == pluck_pin.getTime()) {
+                                pluck_tracking.last_pin_clock->setStatusByte(system_timing_clock);
+                                ++(play_reporting.total_redundant);
+                                pin_it = midiToProcess.erase(pin_it);
+                                goto skip_to_next_pin;
+                            } else if (pluck_tracking.last_pin_clock->getStatusByte() == system_clock_start) {   // Clock Start
+                                pluck_pin.setStatusByte(system_timing_clock);
+                            } else if (pluck_tracking.last_pin_clock->getStatusByte() == system_clock_continue) {   // Clock Continue
+                                pluck_pin.setStatusByte(system_timing_clock);
+                            } else {                                                    // NOT Clock Start or Continue
+                                pluck_tracking.last_pin_clock->setStatusByte(system_clock_stop);
+                            }
+                        } else {
+                            pluck_pin.setStatusByte(system_clock_start);
+                        }
+                        pluck_tracking.last_pin_clock = &pluck_pin;
+                        ++pin_it; // Only increment if no removal
+                    break;
+                    case system_song_pointer:
+                        if (pluck_tracking.last_pin_song_pointer != nullptr) {
+                            if (pluck_tracking.last_pin_song_pointer->getTime() == pluck_pin.getTime()
+                                    && pluck_tracking.last_pin_song_pointer->getStatusByte() == system_song_pointer
+                                    && pluck_tracking.last_pin_song_pointer->getDataByte(1) == pluck_pin.getDataByte(1)
+                                    && pluck_tracking.last_pin_song_pointer->getDataByte(2) == pluck_pin.getDataByte(2)) {
+                                ++(play_reporting.total_redundant);
+                                pin_it = midiToProcess.erase(pin_it);
+                                goto skip_to_next_pin;
+                            }
+                        }
+                        pluck_tracking.last_pin_song_pointer = &pluck_pin;
+                        ++pin_it; // Only increment if no removal
+                    break;
+                    default:
+                        ++pin_it; // Only increment if no removal
+                    break;
+                }
+            break;
+            case action_note_off:
+            {
+                auto& dict_last_on = pluck_tracking.channelpitch_last_pins_note_on;
+                uint16_t channel_pitch = pluck_pin.getChannel() << 8 | pluck_pin.getDataByte();
+				
+                if (dict_last_on.find(channel_pitch) != dict_last_on.end()) { // Note On in the dict found
+
+					auto &last_note_on_pin = dict_last_on[channel_pitch];	// It's a MidiPin*&
+
+					last_note_on_pin->decreaseNotePressedTimes();
+					if (last_note_on_pin->getNotePressedTimes() != 0) {	// The Only configuration to release Note is 1
+						pin_it = midiToProcess.erase(pin_it);
+                		++(play_reporting.total_redundant);  // Note Off as no Note On pair (STATS)
+						// By erasing a pin above, there is no need to increase the pin iterator
+						goto skip_to_next_pin;
+					}
+                }
+                ++pin_it; // Only increments if no removal
+            }
+            break;
+            case action_note_on:
+            {
+                auto& dict_last_on = pluck_tracking.channelpitch_last_pins_note_on;
+                uint16_t channel_pitch = pluck_pin.getChannel() << 8 | pluck_pin.getDataByte();
+
+                if (dict_last_on.find(channel_pitch) != dict_last_on.end()) {	// Note On in the dict found
+
+					auto &last_note_on_pin = dict_last_on[channel_pitch];	// It's a MidiPin*&
+
+					if (last_note_on_pin->getNotePressedTimes() > 0) {
+
+						const double last_note_time_ms = last_note_on_pin->getTime();
+						const double this_note_time_ms = pluck_pin.getTime();
+
+						last_note_on_pin->increaseNotePressedTimes();	// Because the remaining EXTRA note off
+						if (this_note_time_ms == last_note_time_ms) {
+							
+							pin_it = midiToProcess.erase(pin_it);	// Can't trigger the same note twice at the same time
+							++(play_reporting.total_redundant);	// STATS
+							// By erasing a pin above, there is no need to increase the pin iterator
+
+						} else {	// It's still triggerable
+							
+							// New note off message
+							std::vector<unsigned char> midi_pin_message = {
+								static_cast<unsigned char>(pluck_pin.getChannel() | action_note_off),
+								pluck_pin.getDataByte(1),
+								0	// Note off has velocity 0 (Data Byte 2)
+							};
+							pin_it = midiToProcess.insert(pin_it,   // Makes a copy to the place given by pin_it
+								MidiPin(
+										pluck_pin.getTime(),
+										pluck_pin.getMidiDevice(),
+										midi_pin_message
+									)
+								);
+							play_reporting.total_generated++;
+							// THIS IS RIGHT, NEW PIN ADDED, IT'S INTENDED TO BE TWO CONSECUTIVE SKIPS !!
+							// Skips the previously inserted Note Off MidiPin
+							++pin_it;  // Move the iterator to the next element
+							// The usual increment given that it jumps the steps bellow
+                			++pin_it; // Only increments if no removal
+						}
+						goto skip_to_next_pin;
+					}
+                }
+                // First timer Note On
+                // It's safe to use a direct reference given that the Note On midi_pin note parameters are never changed
+				dict_last_on[channel_pitch] = &pluck_pin;
+                ++pin_it; // Only increments if no removal
+            }
+            break;
+            case action_control_change:
+            case action_key_pressure:
+            {
+                auto& dict_last = pluck_tracking.statusdatabyte_last_pin_controlchange;
+                uint16_t status_data_byte = pluck_pin.getStatusByte() << 8 | pluck_pin.getDataByte(1);
+
+                if (dict_last.find(status_data_byte) != dict_last.end()) {  // Key found
+                    auto &last_pin_16 = dict_last[status_data_byte];
+                    if (last_pin_16 != pluck_pin) {
+
+                        last_pin_16.setDataByte(2, pluck_pin.getDataByte(2));
+                        ++pin_it; // Only increment if no removal
+                    } else {
+						pin_it = midiToProcess.erase(pin_it);
+                        ++(play_reporting.total_redundant);
+                    }
+                } else {
+                    // Needs to use a pin dummy copy given that their midi parameters may be changed
+                    dict_last.emplace(status_data_byte, MidiPin(pluck_pin));    // Just a dummy copy
+                    ++pin_it; // Only increment if no removal
+                }
+            }
+            break;
+            case action_pitch_bend:
+            {
+                unsigned char status_byte = pluck_pin.getStatusByte();
+                auto& dict_last = pluck_tracking.statusbyte_last_pins_pitchbend;
+
+                if (dict_last.find(status_byte) != dict_last.end()) {  // Key found
+                    auto &last_pin_8 = dict_last[status_byte];
+                    if (last_pin_8 != pluck_pin) {
+
+                        last_pin_8.setDataByte(1, pluck_pin.getDataByte(1));
+                        last_pin_8.setDataByte(2, pluck_pin.getDataByte(2));
+                        ++pin_it; // Only increment if no removal
+                    } else {
+						pin_it = midiToProcess.erase(pin_it);
+                        ++(play_reporting.total_redundant);
+                    }
+                } else {
+                    // Needs to use a pin dummy copy given that their midi parameters may be changed
+                    dict_last.emplace(status_byte, MidiPin(pluck_pin));    // Just a dummy copy
+                    ++pin_it; // Only increment if no removal
+                }
+            }
+            break;
+            case action_channel_pressure:
+            {
+                unsigned char dict_key = pluck_pin.getStatusByte();
+                auto& dict_last = pluck_tracking.statusbyte_last_pins_pitchbend;
+
+                if (dict_last.find(dict_key) != dict_last.end()) {  // Key found
+                    auto &last_pin_8 = dict_last[dict_key];
+                    if (last_pin_8 != pluck_pin) {
+
+                        last_pin_8.setDataByte(1, pluck_pin.getDataByte(1));
+                        ++pin_it; // Only increment if no removal
+                    } else {
+						pin_it = midiToProcess.erase(pin_it);
+                        ++(play_reporting.total_redundant);
+                    }
+                } else {
+                    // Needs to use a pin dummy copy given that their midi parameters may be changed
+                    dict_last.emplace(dict_key, MidiPin(pluck_pin));    // Just a dummy copy
+                    ++pin_it; // Only increment if no removal
+                }
+            }
+            break;
+
+            default:    // Includes Program Change 0xC0 (Never considered redundant!)
+                ++pin_it; // Only increment if no removal
+            break;
+        }
+
+    skip_to_next_pin: ;	// Does nothing, just processes next pin
+    }
+
+    // Get time_ms of last message
+    auto last_message_time_ms = midiToProcess.back().getTime();
+    
+    
+    for (auto &device_tracking : devices_tracking) {
+        
+        MidiTracking &tracking = device_tracking.second;
+
+        // MIDI NOTES SHALL NOT BE LEFT PRESSED !!
+        // Add the needed note off for all those still on at the end!
+        // Iterate over all keys and values
+        for (const auto& pair : tracking.channelpitch_last_pins_note_on) {
+            // uint16_t channel_pitch = pair.first;
+            auto& last_pin_note_on = pair.second;
+
+            if (last_pin_note_on->getNotePressedTimes() > 0) {
+                // Transform midi on in midi off
+                std::vector<unsigned char> midi_pin_message = {
+                    static_cast<unsigned char>(last_pin_note_on->getChannel() | action_note_off),    // note_off_status_byte
+                    last_pin_note_on->getDataByte(1),
+                    0	// Note off has velocity 0 (Data Byte 2)
+                };
+                // Adds a new MidiPin as a copy to the list of pins to be processed
+                midiToProcess.push_back( MidiPin(last_message_time_ms, device_tracking.first, midi_pin_message) );
+                play_reporting.total_generated++;
+            }
+        }
+
+        // LAST MIDI CLOCK MESSAGE SHALL BE STOP
+        if (tracking.last_pin_clock != nullptr && tracking.last_pin_clock->getStatusByte() == system_timing_clock)
+            tracking.last_pin_clock->setStatusByte(system_clock_stop);    // Clock Stop
+    }
+
+    thinAutomation(midiToProcess, play_reporting);
+    scheduleBursts(midiToProcess, play_reporting);
+}
+
+
+// Bank Select, Data Entry, the switches, (N)RPN and the Channel Mode controllers aren't curves
+static bool isCurveController(unsigned char controller) {
+    return !(controller == 0 || controller == 6 || controller == 32 || controller == 38
+        || (controller >= 64 && controller <= 69) || (controller >= 96 && controller <= 101) || controller >= 120);
+}
+
+void thinAutomation(std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting) {
+
+    // Each controller of each device is a curve of its own
+    std::unordered_map<MidiDevice*, std::unordered_map<uint16_t, std::vector<std::list<MidiPin>::iterator>>> device_curves;
+    for (auto pin_it = midiToProcess.begin(); pin_it != midiToProcess.end(); ++pin_it) {
+        if (pin_it->getDevice() == nullptr || pin_it->getDevice()->getThinningInterval() == 0.0)
+            continue;
+        uint16_t curve_key = pin_it->getStatusByte() << 8;
+        switch (pin_it->getAction()) {
+            case action_control_change:
+                if (!isCurveController(pin_it->getDataByte(1)))
+                    continue;
+                curve_key |= pin_it->getDataByte(1);
+            break;
+            case action_pitch_bend:
+            case action_channel_pressure:
+            break;
+            default:
+                continue;
+        }
+        device_curves[pin_it->getDevice()][curve_key].push_back(pin_it);
+    }
+
+    // In 7 bit steps, like the tolerance
+    auto curveValue = [](const MidiPin &midi_pin) -> double {
+        switch (midi_pin.getAction()) {
+            case action_control_change:
+                return midi_pin.getDataByte(2);
+            case action_pitch_bend:
+                return (midi_pin.getDataByte(1) | midi_pin.getDataByte(2) << 7) / 128.0;
+        }
+        return midi_pin.getDataByte(1);     // Channel Pressure
+    };
+
+    for (auto &device_curve : device_curves) {
+        const double interval_ms = device_curve.first->getThinningInterval();
+        const double tolerance = device_curve.first->getThinningTolerance();
+        for (auto &curve : device_curve.second) {
+            auto &curve_pins = curve.second;
+            std::vector<double> values;
+            values.reserve(curve_pins.size());
+            for (auto curve_pin : curve_pins)
+                values.push_back(curveValue(*curve_pin));
+            std::vector<bool> thinned(curve_pins.size(), false);
+            size_t last_kept = 0;
+            for (size_t pin_i = 1; pin_i < curve_pins.size(); ++pin_i) {
+                const double pin_time_ms = curve_pins[pin_i]->getTime();
+                // Held for at least the interval, like its last value
+                const bool curve_end = pin_i + 1 == curve_pins.size()
+                    || curve_pins[pin_i + 1]->getTime() - pin_time_ms >= interval_ms;
+                const double next_value = pin_i + 1 < curve_pins.size() ? values[pin_i + 1] : values[pin_i];
+                const bool curve_turn = (values[pin_i] - values[pin_i - 1]) * (next_value - values[pin_i]) < 0.0;
+                if (curve_end || pin_time_ms - curve_pins[last_kept]->getTime() >= interval_ms
+                        || (curve_turn && std::abs(values[pin_i] - values[last_kept]) > tolerance)) {
+                    last_kept = pin_i;
+                } else {
+                    thinned[pin_i] = true;
+                }
+            }
+            for (size_t pin_i = 0; pin_i < curve_pins.size(); ++pin_i) {
+                if (thinned[pin_i]) {
+                    midiToProcess.erase(curve_pins[pin_i]);
+                    ++(play_reporting.total_thinned);
+                }
+            }
+        }
+    }
+}
+
+
+void scheduleBursts(std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting) {
+
+    // The pins of each device with the same time, already in priority order
+    struct DeviceBurst {
+        std::vector<std::list<MidiPin>::iterator> burst_pins;
+        double wire_free_ms = std::numeric_limits<double>::lowest();   // When the previous burst was sent
+    };
+    std::unordered_map<MidiDevice*, DeviceBurst> device_bursts;
+    std::vector<MidiDevice*> bursting_devices;
+
+    auto leadBursts = [&](double burst_time_ms) {
+        for (MidiDevice *midi_device : bursting_devices) {
+            DeviceBurst &device_burst = device_bursts[midi_device];
+            const double byte_time_ms = midi_device->getByteTime();
+            // Each message is taken once its last byte arrives, so the burst is centered on the average of those
+            double burst_ms = 0.0;
+            double total_arrivals_ms = 0.0;
+            bool transport_burst = false;
+            for (auto burst_pin : device_burst.burst_pins) {
+                burst_ms += burst_pin->getMessageSize() * byte_time_ms;
+                total_arrivals_ms += burst_ms;
+                transport_burst = transport_burst || burst_pin->getMessageClass() == class_transport;
+            }
+            // Start, Continue and Stop keep their order with the Song Position Pointer and the MMC
+            const double centered_lead_ms = transport_burst ? 0.0 : total_arrivals_ms / device_burst.burst_pins.size();
+            // Never before the port has sent the previous burst
+            const double lead_ms = std::max(0.0,
+                std::min({ centered_lead_ms, MAX_BURST_LEAD_MS, burst_time_ms - device_burst.wire_free_ms }));
+            const double start_ms = std::max(burst_time_ms - lead_ms, device_burst.wire_free_ms);
+            const double saturation_ms = start_ms - (burst_time_ms - centered_lead_ms);
+            if (saturation_ms > 0.001) {
+                play_reporting.total_saturated++;
+                play_reporting.maximum_saturation = std::max(play_reporting.maximum_saturation, saturation_ms);
+            }
+            device_burst.wire_free_ms = start_ms + burst_ms;
+            // The Real-Time messages, like the clock, keep their time, so the led pins are moved before them
+            auto real_time_pin = midiToProcess.end();
+            for (auto burst_pin : device_burst.burst_pins) {
+                if (burst_pin->getStatusByte() >= 0xF8) {
+                    if (real_time_pin == midiToProcess.end())
+                        real_time_pin = burst_pin;
+                } else if (lead_ms > 0.0) {
+                    burst_pin->setLeadTime(midi_device->getLatency() + lead_ms);
+                    if (real_time_pin != midiToProcess.end())
+                        midiToProcess.splice(real_time_pin, midiToProcess, burst_pin);
+                }
+            }
+            device_burst.burst_pins.clear();
+        }
+        bursting_devices.clear();
+    };
+
+    double burst_time_ms = 0.0;
+    for (auto pin_it = midiToProcess.begin(); pin_it != midiToProcess.end(); ++pin_it) {
+        if (pin_it->getDevice() == nullptr)
+            continue;
+        // Shifts the whole stream of the device, the clock included, keeping the pins in their timeline order
+        pin_it->setLeadTime(pin_it->getDevice()->getLatency());
+        if (pin_it->getDevice()->getByteTime() == 0.0)
+            continue;
+        if (pin_it->getTime() != burst_time_ms) {
+            leadBursts(burst_time_ms);
+            burst_time_ms = pin_it->getTime();
+        }
+        DeviceBurst &device_burst = device_bursts[pin_it->getDevice()];
+        if (device_burst.burst_pins.empty())
+            bursting_devices.push_back(pin_it->getDevice());
+        device_burst.burst_pins.push_back(pin_it);
+    }
+    leadBursts(burst_time_ms);
+}
+
+
+// Either the json files or the binary events are played
+// The input is only parsed once the devices are available, as part of the data processing
+static int playInput(const std::function<std::vector<JsonFile>(MidiDeviceResolver&)> &readInput, const MidiEventsData *events_data,
+                        bool verbose, PlayControl *play_control) {
+    
+    disableBackgroundThrottling();
+
+    // Set real-time scheduling
+    setRealTimeScheduling();
+    
+    #ifdef DEBUGGING
+    auto debugging_start = std::chrono::high_resolution_clock::now();
+    auto debugging_now = debugging_start;
+    auto debugging_last = debugging_now;
+    long long completion_time_us = 0;
+    #endif
+
+    PlayReporting play_reporting;
 
-							// The devices JSON list key
-							nlohmann::json json_device_names = jsonPlaylistItem["devices"];
+    // Delays broken down by device and by class of midi message
+    struct ClassReporting {
+        size_t total_messages   = 0;
+        size_t total_bytes      = 0;
+        double total_drag       = 0.0;
+        double total_delay      = 0.0;
+        double maximum_delay    = 0.0;
+        double p95_delay        = 0.0;  // tail latency
+        double p99_delay        = 0.0;  // tail latency
+        std::vector<double> delays;
+    };
+    struct DeviceReporting {
+        std::string device_name;
+        std::array<ClassReporting, total_message_classes> message_classes;
+        MidiDevice::ByteStreamReporting byte_stream;
+        MidiDevice::OutputReporting output;
+    };
+    std::vector<DeviceReporting> devices_reporting;
 
-							last_called_midi_device = nullptr; // No available device found at start
-							// It's a list of Devices that is given as Device
-							for (std::string device_name : json_device_names) {
-								
-								if (connected_devices_by_name.find(device_name) != connected_devices_by_name.end()) {
-									last_called_midi_device = connected_devices_by_name[device_name];
-									goto skip_to_next_item;
-								}
-						
-								if (unavailable_devices.find(device_name) != unavailable_devices.end()) {
-									continue;
-								}
-						
-								for (auto &available_device : available_midi_devices) {
-									if (available_device.getName().find(device_name) != std::string::npos) {
-										//
-										// Where the Device Port is connected/opened (Main reason for errors)
-										//
-										if (available_device.openPort()) {	// Where the connection happens
-											connected_devices_by_name[device_name] = &available_device; 
-											last_called_midi_device = &available_device;
-
-											goto skip_to_next_item; // For Message devices only the first one found is connected and NOT all of them
-
-										} else {
-											connected_devices_by_name[device_name] = nullptr; 
-										}
-									} else {
-										unavailable_devices.insert(device_name);
-									}
-								}
-							}
+    
+    if (verbose) std::cout << "JsonMidiPlayer version: " << VERSION << std::endl;
 
-						// Where the clock is processed
-						} else if (jsonPlaylistItem.contains("clock")) {
-
-							try
-							{
-								// Access the value associated with the key "clock"
-								auto clockValue = jsonPlaylistItem.at("clock");	// Same as jsonElement["clock"]
-								// The devices JSON list key
-								const unsigned int total_clock_pulses = clockValue["total_clock_pulses"];
-								const unsigned int pulse_duration_min_numerator = clockValue["pulse_duration_min_numerator"];
-								const unsigned int pulse_duration_min_denominator = clockValue["pulse_duration_min_denominator"];
-								auto last_position_ms = get_time_ms(total_clock_pulses * pulse_duration_min_numerator, pulse_duration_min_denominator);
-								const nlohmann::json clocked_device_names = clockValue["clocked_devices"];
-								const nlohmann::json controlled_device_names = clockValue["controlled_devices"];
-
-								if (total_clock_pulses > 0 && pulse_duration_min_numerator > 0 && pulse_duration_min_denominator > 0) {
-
-									std::unordered_set<MidiDevice*> clocked_devices;
-
-									// First time any Device is tried to be connected, so, none is connected at this moment
-									// It's a list of Devices that is given as Device
-									for (std::string device_name : clocked_device_names) {
-
-										for (auto &available_device : available_midi_devices) {
-											if (available_device.getName().find(device_name) != std::string::npos) {
-												//
-												// Where the Device Port is connected/opened (Main reason for errors)
-												//
-												if (available_device.openPort()) {	// Where the connection happens
-
-													if (clocked_devices.find(&available_device) != clocked_devices.end())
-														continue;   // Already clocked!
-
-													connected_devices_by_name[device_name] = &available_device;
-													clocked_devices.insert(&available_device);
-														
-													// High Priority 3.1
-													midiToProcess.push_back( MidiPin(0.0, &available_device, { system_clock_start }, 0x31) );
-													play_reporting.total_generated++;
-
-													for (unsigned int pulse_i = 1; pulse_i < total_clock_pulses; ++pulse_i) {
-
-														midiToProcess.push_back(MidiPin(
-															get_time_ms(pulse_i * pulse_duration_min_numerator, pulse_duration_min_denominator),
-															&available_device,
-															{ system_timing_clock },
-															0x01	// Top Priority 0.1
-														));
-														play_reporting.total_generated++;
-													}
-
-													// Lowest priority 11.0
-													midiToProcess.push_back(MidiPin(last_position_ms, &available_device, { system_clock_stop }, 0xB0));
-													play_reporting.total_generated++;
-
-													// Lowest priority 11.1
-													midiToProcess.push_back(MidiPin(last_position_ms, &available_device, { system_song_pointer, 0, 0 }, 0xB1));
-													play_reporting.total_generated++;
+    // Where the playing happens
+    {
+        // Under its own scope in order to disconnect all devices before the stats reporting !
+        std::vector<MidiDevice> available_midi_devices;
+        std::list<MidiPin> midiToProcess;
 
-												} else {
-													connected_devices_by_name[device_name] = nullptr;
-												}
-											} else {
-												// Just adds it as a processed device
-												unavailable_devices.insert(device_name);
-											}
-										}
-									}
+        // Delays reported as the pins are played, given that seeking and looping may play them again
+        size_t total_played = 0;
+        double squared_deviations = 0.0;
+        std::unordered_map<MidiDevice*, std::array<ClassReporting, total_message_classes>> classes_reporting;
+        std::minstd_rand delays_sampling;
+        auto reportDelay = [&](const MidiPin &midi_pin) {
+            const double delay_time_ms = midi_pin.getDelayTime();
+            total_played++;
+            play_reporting.total_delay += delay_time_ms;
+            play_reporting.maximum_delay = std::max(play_reporting.maximum_delay, delay_time_ms);
+            play_reporting.minimum_delay = total_played == 1
+                ? delay_time_ms : std::min(play_reporting.minimum_delay, delay_time_ms);
+            // Running average and deviations (Welford)
+            const double deviation = delay_time_ms - play_reporting.average_delay;
+            play_reporting.average_delay += deviation / total_played;
+            squared_deviations += deviation * (delay_time_ms - play_reporting.average_delay);
+
+            ClassReporting &class_reporting = classes_reporting[midi_pin.getDevice()][midi_pin.getMessageClass()];
+            class_reporting.total_messages++;
+            class_reporting.total_bytes += midi_pin.getMessageSize();
+            class_reporting.total_delay += delay_time_ms;
+            class_reporting.maximum_delay = std::max(class_reporting.maximum_delay, delay_time_ms);
+            if (delay_time_ms > DRAG_DURATION_MS)
+                class_reporting.total_drag += delay_time_ms - DRAG_DURATION_MS;  // Same as the playing loop
+            if (class_reporting.delays.size() < DELAY_SAMPLES) {
+                class_reporting.delays.push_back(delay_time_ms);
+            } else {
+                // Reservoir sampling, each delay so far is as likely to be kept
+                size_t sample_i = std::uniform_int_distribution<size_t>(
+                    0, class_reporting.total_messages - 1)(delays_sampling);
+                if (sample_i < DELAY_SAMPLES)
+                    class_reporting.delays[sample_i] = delay_time_ms;
+            }
+        };
+
+        // The devices are discovered and the requested ports opened in the background while the input is parsed
+        MidiDeviceResolver device_resolver(available_midi_devices, verbose);
+        if (play_control != nullptr && play_control->playing_cpu >= 0)
+            device_resolver.setOutputCpu(play_control->playing_cpu, &play_control->pinning_failed);
+        device_resolver.startDiscovery();
+        if (events_data != nullptr) {
+            for (size_t device_i = 0; device_i < events_data->total_devices; ++device_i) {
+                if (events_data->device_names[device_i] != nullptr)
+                    device_resolver.requestNames({ events_data->device_names[device_i] });
+            }
+        }
+
+        //
+        // Where the JSON content is processed and added up the Pluck midi messages
+        //
 
-									std::unordered_set<MidiDevice*> controlled_devices;
-
-									// First time any Device is tried to be connected, so, none is connected at this moment
-									// It's a list of Devices that is given as Device
-									for (std::string device_name : controlled_device_names) {
-
-										for (auto &available_device : available_midi_devices) {
-											if (available_device.getName().find(device_name) != std::string::npos) {
-												//
-												// Where the Device Port is connected/opened (Main reason for errors)
-												//
-												if (available_device.openPort()) {	// Where the connection happens
-
-													if (controlled_devices.find(&available_device) != controlled_devices.end())
-														continue;   // Already controlled!
-
-													connected_devices_by_name[device_name] = &available_device;
-													controlled_devices.insert(&available_device);
-													
-													// Action			MMC	SysEx
-													// Stop				F0 7F 7F 06 01 F7
-													// Play				F0 7F 7F 06 02 F7
-													// Deferred Play	F0 7F 7F 06 03 F7
-													// Fast Forward		F0 7F 7F 06 04 F7
-													// Rewind			F0 7F 7F 06 05 F7
-													// Record Strobe	F0 7F 7F 06 06 F7
-													// Record Exit		F0 7F 7F 06 07 F7
-													// Pause			F0 7F 7F 06 09 F7
-													// Locate			F0 7F 7F 06 44 … F7
-
-													// MMC - Play
-													midiToProcess.push_back(MidiPin(
-														0.0,
-														&available_device,
-														{ system_sysex_start, 0x7F, 0x7F, 0x06, 0x02, system_sysex_end },
-														0x30    // High priority 3.0
-													));
-													play_reporting.total_generated++;
-
-													// MMC - Stop
-													midiToProcess.push_back(MidiPin(
-														last_position_ms,
-														&available_device,
-														{ system_sysex_start, 0x7F, 0x7F, 0x06, 0x01, system_sysex_end },
-														0xF1    // Lowest priority 16.1
-													));
-													play_reporting.total_generated++;
-													
-													// MMC - Rewind
-													midiToProcess.push_back(MidiPin(
-														last_position_ms,
-														&available_device,
-														{ system_sysex_start, 0x7F, 0x7F, 0x06, 0x05, system_sysex_end },
-														0xF2    // Lowest priority 16.2
-													));
-													play_reporting.total_generated++;
+        auto data_processing_start = std::chrono::high_resolution_clock::now();
 
-												} else {
-													connected_devices_by_name[device_name] = nullptr;
-												}
-											} else {
-												// Just adds it as a processed device
-												unavailable_devices.insert(device_name);
-											}
-										}
-									}
-								}
-							} catch (const std::exception& e) {
-								if (verbose) std::cerr << "Error: " << e.what() << std::endl;
-							}
+        // Sequential playing only processes the first file upfront, the next ones are processed while playing
+        const double sequential_gap_ms = play_control != nullptr ? play_control->sequential_gap_ms.load() : -1.0;
+        // Streaming keeps playing the fragments being appended until the input is closed, even if it starts empty
+        // Closed right after appending, the fragments already appended are still played
+        const bool streaming_input = play_control != nullptr
+            && (play_control->streaming_input.load() || play_control->hasFragments());
+        std::vector<JsonFile> json_files;
+        size_t next_file = 0;
 
-						}
-					skip_to_next_item: ;    // Does nothing, just jumps to next item
-					}
+        try {
+            json_files = readInput(device_resolver);
+        } catch (const nlohmann::json::exception& e) {
+            if (verbose) std::cerr << "JSON parse error: " << e.what() << std::endl;
+        }
 
-                } else {
-                    if (verbose) std::cout << "JSON file is empty." << std::endl;
+        // From now on no device is added, so that their positions are stable ids for the whole session
+        int discovery_result = device_resolver.finishDiscovery();
+        if (discovery_result != 0)
+            return discovery_result;
+
+        if (play_control != nullptr) {
+            for (auto &midi_device : available_midi_devices) {
+                for (const DeviceSetting &device_bandwidth : play_control->device_bandwidths) {
+                    if (midi_device.getName().find(device_bandwidth.device_name) != std::string::npos)
+                        // 10 bits per byte, being kbaud the bits per millisecond
+                        midi_device.setByteTime(device_bandwidth.value > 0.0 ? 10.0 / device_bandwidth.value : 0.0);
+                }
+                for (const DeviceSetting &device_thinning : play_control->device_thinning) {
+                    if (midi_device.getName().find(device_thinning.device_name) != std::string::npos)
+                        midi_device.setThinning(device_thinning.value, play_control->thinning_tolerance);
                 }
+                for (const DeviceSetting &device_latency : play_control->device_latencies) {
+                    if (midi_device.getName().find(device_latency.device_name) != std::string::npos)
+                        midi_device.setLatency(device_latency.value);
+                }
+            }
+        }
+
+        #ifdef DEBUGGING
+        debugging_now = std::chrono::high_resolution_clock::now();
+        auto completion_time = std::chrono::duration_cast<std::chrono::microseconds>(debugging_now - debugging_last);
+        completion_time_us = completion_time.count();
+        std::cout << "MIDI DEVICES FULLY PROCESSED IN: " << completion_time_us << " microseconds" << std::endl;
+        debugging_last = std::chrono::high_resolution_clock::now();
+        #endif
 
+        try {
+            for (; next_file < json_files.size(); ++next_file) {
+                processJsonFile(json_files[next_file], device_resolver, midiToProcess, play_reporting, verbose);
+                if (sequential_gap_ms >= 0.0 && midiToProcess.size() > 0) {
+                    ++next_file;
+                    break;
+                }
             }
-        } catch (const nlohmann::json::parse_error& e) {
+        } catch (const nlohmann::json::exception& e) {
             if (verbose) std::cerr << "JSON parse error: " << e.what() << std::endl;
+            next_file = json_files.size();
         }
 
+        if (events_data != nullptr)
+            processMidiEvents(*events_data, device_resolver, midiToProcess, play_reporting);
+
         if (verbose) std::cout << std::endl;
 
         #ifdef DEBUGGING
@@ -581,7 +2149,7 @@ int PlayList(const char* json_str, bool verbose) {
         debugging_last = std::chrono::high_resolution_clock::now();
         #endif
 
-        if (midiToProcess.size() == 0) {
+        if (midiToProcess.size() == 0 && !streaming_input) {
 
             auto data_processing_finish = std::chrono::high_resolution_clock::now();
 
@@ -595,6 +2163,7 @@ int PlayList(const char* json_str, bool verbose) {
             if (verbose) std::cout << "\tTotal validated Midi Messages (accepted): " << std::setw(10) << play_reporting.total_validated << std::endl;
             if (verbose) std::cout << "\tTotal incorrect Midi Messages (excluded): " << std::setw(10) << play_reporting.total_incorrect << std::endl;
             if (verbose) std::cout << "\tTotal redundant Midi Messages (excluded): " << std::setw(10) << play_reporting.total_redundant << std::endl;
+            if (verbose) std::cout << "\tTotal thinned Midi Messages (excluded):   " << std::setw(10) << play_reporting.total_thinned << std::endl;
             if (verbose) std::cout << "\tTotal resultant Midi Messages (included): " << std::setw(10) << midiToProcess.size() << std::endl;
 
         } else {
@@ -603,377 +2172,659 @@ int PlayList(const char* json_str, bool verbose) {
             // Where the existing Midi messages are sorted by time and other parameters
             //
 
-            // Two levels sorting criteria
-            midiToProcess.sort([]( const MidiPin &a, const MidiPin &b ) {
-                
-                // Time is the primary sorting criteria
-                if (a.getTime() != b.getTime())  
-                    return a.getTime() < b.getTime();           // Primary: Sort by time (ascending)
-            
-                // Then sort by Priority (Ascendent)
-                // Must be "<" instead of "<=" due to the mysterious "strict weak ordering"
-                // Explanation here: https://youtu.be/fi0CQ7laiXE?si=fysJC-UdG2lJytjU&t=1542
-                return a.getPriority() < b.getPriority();      // Secondary: Sort by priority (ascending)
-                
-            });
+            processMidiPins(midiToProcess, play_reporting);
+
+            // Exporting processes the sequential files upfront, given that the whole timeline is written at once
+            const char *export_smf = play_control != nullptr ? play_control->export_smf : nullptr;
+            if (export_smf != nullptr) {
+                double offset_ms = (midiToProcess.size() > 0 ? midiToProcess.back().getTime() : 0.0) + sequential_gap_ms;
+                for (; next_file < json_files.size(); ++next_file) {
+                    std::list<MidiPin> file_pins;
+                    try {
+                        processJsonFile(json_files[next_file], device_resolver, file_pins, play_reporting, verbose, offset_ms);
+                    } catch (const std::exception& e) {
+                        if (verbose) std::cerr << "JSON processing error: " << e.what() << std::endl;
+                    }
+                    if (file_pins.size() == 0)
+                        continue;
+                    offset_ms = file_pins.back().getTime() + sequential_gap_ms;
+                    processMidiPins(file_pins, play_reporting);
+                    midiToProcess.merge(file_pins, [](const MidiPin &a, const MidiPin &b) {
+                        return a.getTime() < b.getTime() || (a.getTime() == b.getTime() && a.getPriority() < b.getPriority());
+                    });
+                }
+            }
 
             #ifdef DEBUGGING
             debugging_now = std::chrono::high_resolution_clock::now();
             completion_time = std::chrono::duration_cast<std::chrono::microseconds>(debugging_now - debugging_last);
             completion_time_us = completion_time.count();
-            std::cout << "SORTING FULLY PROCESSED IN: " << completion_time_us << " microseconds" << std::endl;
+            std::cout << "MIDI MESSAGES CLEANING UP FULLY PROCESSED IN: " << completion_time_us << " microseconds" << std::endl;
             debugging_last = std::chrono::high_resolution_clock::now();
             #endif
 
+            auto data_processing_finish = std::chrono::high_resolution_clock::now();
+            auto data_processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(data_processing_finish - data_processing_start);
+
+            play_reporting.json_processing = data_processing_time.count();
+
+            // Where the reporting is finally done
+            if (verbose) std::cout << "Data stats reporting:" << std::endl;
+            if (verbose) std::cout << "\tMidi Messages processing time (ms):       " << std::setw(10) << play_reporting.json_processing << std::endl;
+            if (verbose) std::cout << "\tTotal generated Midi Messages (included): " << std::setw(10) << play_reporting.total_generated << std::endl;
+            if (verbose) std::cout << "\tTotal validated Midi Messages (accepted): " << std::setw(10) << play_reporting.total_validated << std::endl;
+            if (verbose) std::cout << "\tTotal incorrect Midi Messages (excluded): " << std::setw(10) << play_reporting.total_incorrect << std::endl;
+            if (verbose) std::cout << "\tTotal redundant Midi Messages (excluded): " << std::setw(10) << play_reporting.total_redundant << std::endl;
+            if (verbose) std::cout << "\tTotal thinned Midi Messages (excluded):   " << std::setw(10) << play_reporting.total_thinned << std::endl;
+            if (verbose) std::cout << "\tTotal resultant Midi Messages (included): " << std::setw(10) << midiToProcess.size() << std::endl;
+            if (verbose && play_reporting.total_saturated > 0) {
+                // Warns that the ports are too slow for the bursts, being them sent as soon as possible
+                std::cout << "\tTotal saturated Midi bursts (late onset): " << std::setw(10) << play_reporting.total_saturated << std::endl;
+                std::cout << "\tMaximum late onset of the bursts (ms):    " << std::setw(10)
+                    << std::fixed << std::setprecision(3) << play_reporting.maximum_saturation << std::endl;
+            }
+
+            if (export_smf != nullptr) {
+                if (!writeSmfFile(export_smf, midiToProcess))
+                    return EXIT_FAILURE;
+                if (verbose) std::cout << "The data was exported to the Standard MIDI File: " << export_smf << std::endl;
+                return 0;
+            }
+
+            const double last_time_ms = midiToProcess.size() > 0 ? midiToProcess.back().getTime() : 0.0;
+            if (play_control != nullptr) play_control->duration_ms.store(last_time_ms);
+            double playing_rate = play_control != nullptr && play_control->playing_rate.load() > 0.0 ? play_control->playing_rate.load() : 1.0;
+            size_t duration_time_sec = std::round(last_time_ms / 1000 / playing_rate);
+            if (verbose) std::cout << "The data will now be played during "
+                << duration_time_sec / 60 << " minutes and " << duration_time_sec % 60 << " seconds..." << std::endl;
+
             //
-            // Where the redundant Midi messages lists are Cleaned up and processed
+            // Where the Midi messages are sent to each Device
             //
 
-            // Loop through the list and remove elements
-            for (auto pin_it = midiToProcess.begin(); pin_it != midiToProcess.end(); ) {
-
-                // Auxiliary variables
-                MidiPin &pluck_pin = *pin_it;	// Just an handy conversion
-                MidiDevice &pluck_device = *pluck_pin.getDevice();
-
-                switch (pluck_pin.getAction()) {
-                    case action_system:
-                        switch (pluck_pin.getStatusByte()) {
-                            case system_timing_clock:
-                                if (pluck_device.last_pin_clock != nullptr) {
-                                    if (pluck_device.last_pin_clock->getTime() == pluck_pin.getTime()) {
-                                        if (pluck_device.last_pin_clock->getStatusByte() == system_clock_stop) {      // Clock Stop
-                                            pluck_device.last_pin_clock->setStatusByte(system_timing_clock);
-                                        }
-                                        ++(play_reporting.total_redundant);
-                                        pin_it = midiToProcess.erase(pin_it);
-                                        goto skip_to_next_pin;
-                                    } else if (pluck_device.last_pin_clock->getStatusByte() == system_clock_stop) {   // Clock Stop
-                                        pluck_pin.setStatusByte(system_clock_continue);
-                                    }
-                                } else {
-                                    pluck_pin.setStatusByte(system_clock_start);
-                                }
-                                pluck_device.last_pin_clock = &pluck_pin;
-                                ++pin_it; // Only increment if no removal
-                            break;
-                            case system_clock_start:
-                                if (pluck_device.last_pin_clock != nullptr) {
-                                    if (pluck_device.last_pin_clock->getTime() == pluck_pin.getTime()) {
-                                        if (pluck_device.last_pin_clock->getStatusByte() == system_clock_stop) {      // Clock Stop
-                                            pluck_device.last_pin_clock->setStatusByte(system_timing_clock);
-                                        }
-                                        ++(play_reporting.total_redundant);
-                                        pin_it = midiToProcess.erase(pin_it);
-                                        goto skip_to_next_pin;
-                                    } else if (pluck_device.last_pin_clock->getStatusByte() == system_clock_stop) {   // Clock Stop
-                                        pluck_pin.setStatusByte(system_clock_continue);
-                                    } else {
-                                        pluck_pin.setStatusByte(system_timing_clock);
-                                    }
-                                }
-                                pluck_device.last_pin_clock = &pluck_pin;
-                                ++pin_it; // Only increment if no removal
-                            break;
-                            case system_clock_stop:
-                                if (pluck_device.last_pin_clock != nullptr) {
-                                    if (pluck_device.last_pin_clock->getTime() == pluck_pin.getTime()) {
-                                        pluck_device.last_pin_clock->setStatusByte(system_clock_stop);
-                                        ++(play_reporting.total_redundant);
-                                        pin_it = midiToProcess.erase(pin_it);
-                                        goto skip_to_next_pin;
-                                    } else if (pluck_device.last_pin_clock->getStatusByte() == system_clock_stop) {   // Clock Stop
-                                        ++(play_reporting.total_redundant);
-                                        pin_it = midiToProcess.erase(pin_it);
-                                        goto skip_to_next_pin;
-                                    }
-                                }
-                                pluck_device.last_pin_clock = &pluck_pin;
-                                ++pin_it; // Only increment if no removal
-                            break;
-                            case system_clock_continue:
-                                if (pluck_device.last_pin_clock != nullptr) {
-                                    if (pluck_device.last_pin_clock->getTime() == pluck_pin.getTime()) {
-                                        pluck_device.last_pin_clock->setStatusByte(system_timing_clock);
-                                        ++(play_reporting.total_redundant);
-                                        pin_it = midiToProcess.erase(pin_it);
-                                        goto skip_to_next_pin;
-                                    } else if (pluck_device.last_pin_clock->getStatusByte() == system_clock_start) {   // Clock Start
-                                        pluck_pin.setStatusByte(system_timing_clock);
-                                    } else if (pluck_device.last_pin_clock->getStatusByte() == system_clock_continue) {   // Clock Continue
-                                        pluck_pin.setStatusByte(system_timing_clock);
-                                    } else {                                                    // NOT Clock Start or Continue
-                                        pluck_device.last_pin_clock->setStatusByte(system_clock_stop);
-                                    }
-                                } else {
-                                    pluck_pin.setStatusByte(system_clock_start);
-                                }
-                                pluck_device.last_pin_clock = &pluck_pin;
-                                ++pin_it; // Only increment if no removal
-                            break;
-                            case system_song_pointer:
-                                if (pluck_device.last_pin_song_pointer != nullptr) {
-                                    if (pluck_device.last_pin_song_pointer->getTime() == pluck_pin.getTime()
-                                            && pluck_device.last_pin_song_pointer->getStatusByte() == system_song_pointer
-                                            && pluck_device.last_pin_song_pointer->getDataByte(1) == pluck_pin.getDataByte(1)
-                                            && pluck_device.last_pin_song_pointer->getDataByte(2) == pluck_pin.getDataByte(2)) {
-                                        ++(play_reporting.total_redundant);
-                                        pin_it = midiToProcess.erase(pin_it);
-                                        goto skip_to_next_pin;
-                                    }
-                                }
-                                pluck_device.last_pin_song_pointer = &pluck_pin;
-                                ++pin_it; // Only increment if no removal
-                            break;
-                            default:
-                                ++pin_it; // Only increment if no removal
-                            break;
+            // Index of the devices states needed to seek and to loop
+            std::vector<MidiCheckpoint> checkpoints;
+            if (play_control != nullptr)
+                checkpoints = buildCheckpoints(midiToProcess);
+
+            // The next files and the streamed fragments are processed in the background and
+            // handed over one at a time to be merged, so that the playing never waits for them
+            struct MidiHandover {
+                std::list<MidiPin> midi_pins;
+                std::vector<MidiCheckpoint> checkpoints;
+                size_t flushed_playing = 0;     // Dropped by the playing once flushed again
+            };
+            std::atomic<MidiHandover*> midi_handover{nullptr};
+            std::atomic<bool> processing_pending{next_file < json_files.size() || streaming_input};
+            std::atomic<bool> playing_finished{false};
+            PlayReporting processing_reporting;
+            std::thread processing_thread;
+            if (processing_pending.load()) {
+                processing_thread = std::thread([&, offset_ms = last_time_ms + sequential_gap_ms]() mutable {
+
+                    setNormalScheduling();  // Inherited from the playing thread otherwise
+                    double streamed_end_ms = last_time_ms;
+
+                    // Only one handover waits to be merged at a time
+                    auto handOver = [&](MidiHandover *handover) -> bool {
+                        processMidiPins(handover->midi_pins, processing_reporting);
+                        streamed_end_ms = std::max(streamed_end_ms, handover->midi_pins.back().getTime());
+                        handover->checkpoints = buildCheckpoints(handover->midi_pins);
+                        MidiHandover *empty_slot = nullptr;
+                        while (!midi_handover.compare_exchange_weak(empty_slot, handover)) {
+                            empty_slot = nullptr;
+                            if (playing_finished.load()) {
+                                delete handover;
+                                return false;
+                            }
+                            highResolutionSleep(CONTROL_POLLING_US);
                         }
-                    break;
-                    case action_note_off:
-                    {
-                        auto& dict_last_on = pluck_device.channelpitch_last_pins_note_on;
-                        uint16_t channel_pitch = pluck_pin.getChannel() << 8 | pluck_pin.getDataByte();
-						
-                        if (dict_last_on.find(channel_pitch) != dict_last_on.end()) { // Note On in the dict found
-
-							auto &last_note_on_pin = dict_last_on[channel_pitch];	// It's a MidiPin*&
-
-							last_note_on_pin->decreaseNotePressedTimes();
-							if (last_note_on_pin->getNotePressedTimes() != 0) {	// The Only configuration to release Note is 1
-								pin_it = midiToProcess.erase(pin_it);
-                        		++(play_reporting.total_redundant);  // Note Off as no Note On pair (STATS)
-								// By erasing a pin above, there is no need to increase the pin iterator
-								goto skip_to_next_pin;
-							}
+                        return true;
+                    };
+
+                    for (; next_file < json_files.size(); ++next_file) {
+                        MidiHandover *handover = new MidiHandover();
+                        try {
+                            processJsonFile(json_files[next_file], device_resolver, handover->midi_pins, processing_reporting, verbose, offset_ms);
+                        } catch (const std::exception& e) {
+                            if (verbose) std::cerr << "JSON processing error: " << e.what() << std::endl;
                         }
-                        ++pin_it; // Only increments if no removal
-                    }
-                    break;
-                    case action_note_on:
-                    {
-                        auto& dict_last_on = pluck_device.channelpitch_last_pins_note_on;
-                        uint16_t channel_pitch = pluck_pin.getChannel() << 8 | pluck_pin.getDataByte();
-
-                        if (dict_last_on.find(channel_pitch) != dict_last_on.end()) {	// Note On in the dict found
-
-							auto &last_note_on_pin = dict_last_on[channel_pitch];	// It's a MidiPin*&
-
-							if (last_note_on_pin->getNotePressedTimes() > 0) {
-
-								const double last_note_time_ms = last_note_on_pin->getTime();
-								const double this_note_time_ms = pluck_pin.getTime();
-
-								last_note_on_pin->increaseNotePressedTimes();	// Because the remaining EXTRA note off
-								if (this_note_time_ms == last_note_time_ms) {
-									
-									pin_it = midiToProcess.erase(pin_it);	// Can't trigger the same note twice at the same time
-									++(play_reporting.total_redundant);	// STATS
-									// By erasing a pin above, there is no need to increase the pin iterator
-
-								} else {	// It's still triggerable
-									
-									// New note off message
-									std::vector<unsigned char> midi_pin_message = {
-										static_cast<unsigned char>(pluck_pin.getChannel() | action_note_off),
-										pluck_pin.getDataByte(1),
-										0	// Note off has velocity 0 (Data Byte 2)
-									};
-									pin_it = midiToProcess.insert(pin_it,   // Makes a copy to the place given by pin_it
-										MidiPin(
-												pluck_pin.getTime(),
-												pluck_pin.getMidiDevice(),
-												midi_pin_message
-											)
-										);
-									play_reporting.total_generated++;
-									// THIS IS RIGHT, NEW PIN ADDED, IT'S INTENDED TO BE TWO CONSECUTIVE SKIPS !!
-									// Skips the previously inserted Note Off MidiPin
-									++pin_it;  // Move the iterator to the next element
-									// The usual increment given that it jumps the steps bellow
-                        			++pin_it; // Only increments if no removal
-								}
-								goto skip_to_next_pin;
-							}
+                        if (handover->midi_pins.size() == 0) {
+                            delete handover;
+                            continue;
+                        }
+                        offset_ms = handover->midi_pins.back().getTime() + sequential_gap_ms;
+                        if (!handOver(handover)) {
+                            processing_pending.store(false);
+                            return;
                         }
-                        // First timer Note On
-                        // It's safe to use a direct reference given that the Note On midi_pin note parameters are never changed
-						dict_last_on[channel_pitch] = &pluck_pin;
-                        ++pin_it; // Only increments if no removal
                     }
-                    break;
-                    case action_control_change:
-                    case action_key_pressure:
-                    {
-                        auto& dict_last = pluck_device.statusdatabyte_last_pin_controlchange;
-                        uint16_t status_data_byte = pluck_pin.getStatusByte() << 8 | pluck_pin.getDataByte(1);
 
-                        if (dict_last.find(status_data_byte) != dict_last.end()) {  // Key found
-                            auto &last_pin_16 = dict_last[status_data_byte];
-                            if (last_pin_16 != pluck_pin) {
-
-                                last_pin_16.setDataByte(2, pluck_pin.getDataByte(2));
-                                ++pin_it; // Only increment if no removal
-                            } else {
-								pin_it = midiToProcess.erase(pin_it);
-                                ++(play_reporting.total_redundant);
+                    // Late pins are moved to the earliest time they can still be merged at, returns the first pin time
+                    auto moveLatePins = [&](std::list<MidiPin> &midi_pins, double timeline_ms) -> double {
+                        double horizon_ms = timeline_ms + CONTROL_POLLING_US / 1000.0;
+                        double first_pin_ms = std::numeric_limits<double>::max();
+                        for (auto pin_it = midi_pins.begin(); pin_it != midi_pins.end(); ++pin_it) {
+                            if (pin_it->getTime() < horizon_ms) {
+                                double lateness_ms = horizon_ms - pin_it->getTime();
+                                processing_reporting.total_late++;
+                                processing_reporting.total_lateness += lateness_ms;
+                                processing_reporting.maximum_lateness = std::max(processing_reporting.maximum_lateness, lateness_ms);
+                                midi_pins.insert(pin_it, MidiPin(horizon_ms, pin_it->getDevice(), pin_it->getMessage(), pin_it->getPriority()));
+                                pin_it = std::prev(midi_pins.erase(pin_it));
+                            }
+                            first_pin_ms = std::min(first_pin_ms, pin_it->getTime());
+                        }
+                        play_control->late_pins.store(processing_reporting.total_late);
+                        return first_pin_ms;
+                    };
+
+                    ShmRingHeader *shm_ring = play_control != nullptr ? play_control->shm_ring : nullptr;
+                    ShmRingDevices ring_devices;
+                    size_t processed_flushes = 0;
+
+                    while (streaming_input) {
+                        // Closed is read before taking the fragments so that the last ones are never missed
+                        bool input_closed = !play_control->streaming_input.load();
+                        StreamFragment *fragment = play_control->takeFragments();
+                        // Read after taking the fragments, the ones taken before a flush are dropped by the playing
+                        size_t flushed_playing = play_control->flushed_playing.load();
+                        if (flushed_playing != processed_flushes) {
+                            processed_flushes = flushed_playing;
+                            streamed_end_ms = 0.0;  // Queued from now on again
+                        }
+                        if (shm_ring != nullptr) {
+                            // The ring events are already pins, so they are handed over as they are taken
+                            bool ring_done = isShmRingDone(shm_ring);
+                            shm_ring->timeline_ms.store(play_control->timeline_ms.load(), std::memory_order_relaxed);
+                            std::list<MidiPin> ring_pins;
+                            takeShmEvents(shm_ring, device_resolver, ring_devices, ring_pins, processing_reporting);
+                            if (ring_pins.size() > 0) {
+                                MidiHandover *handover = new MidiHandover();
+                                handover->flushed_playing = flushed_playing;
+                                handover->midi_pins.splice(handover->midi_pins.end(), ring_pins);
+                                moveLatePins(handover->midi_pins, play_control->timeline_ms.load());
+                                if (!handOver(handover))
+                                    input_closed = ring_done = true;
+                            }
+                            input_closed = input_closed || ring_done;
+                        }
+                        if (fragment == nullptr) {
+                            if (input_closed || playing_finished.load())
+                                break;
+                            highResolutionSleep(CONTROL_POLLING_US);
+                            continue;
+                        }
+                        while (fragment != nullptr) {
+                            MidiHandover *handover = new MidiHandover();
+                            handover->flushed_playing = flushed_playing;
+                            try {
+                                std::vector<JsonFile> fragment_files;
+                                if (fragment->files_read)
+                                    fragment_files = std::move(fragment->json_files);
+                                else if (!fragment->events_read)
+                                    fragment_files = readJsonFiles(reinterpret_cast<const unsigned char*>(fragment->json_str.data()),
+                                        fragment->json_str.size(), format_detect, verbose);
+                                // Parsed first so that the parsing time doesn't make the fragment late
+                                double offset_ms = fragment->offset_ms;
+                                double horizon_ms = play_control->timeline_ms.load() + CONTROL_POLLING_US / 1000.0;
+                                if (fragment->fragment_at == fragment_at_now)
+                                    offset_ms += horizon_ms;
+                                else if (fragment->fragment_at == fragment_at_end)
+                                    offset_ms += std::max(streamed_end_ms, horizon_ms);
+                                for (JsonFile &fragment_file : fragment_files)
+                                    processJsonFile(fragment_file, device_resolver, handover->midi_pins, processing_reporting, verbose, offset_ms);
+                                if (fragment->events_read) {
+                                    std::vector<const char*> device_names_table;
+                                    for (const std::string &device_name : fragment->device_names)
+                                        device_names_table.push_back(device_name.empty() ? nullptr : device_name.c_str());
+                                    MidiEventsData events_data = {
+                                        fragment->events.data(), fragment->events.size(),
+                                        device_names_table.data(), device_names_table.size(),
+                                        fragment->sysex_data.data(), fragment->sysex_data.size()
+                                    };
+                                    processMidiEvents(events_data, device_resolver, handover->midi_pins, processing_reporting, offset_ms);
+                                }
+                            } catch (const std::exception& e) {
+                                if (verbose) std::cerr << "JSON fragment error: " << e.what() << std::endl;
+                            }
+                            auto appended_at = fragment->appended_at;
+                            StreamFragment *next_fragment = fragment->next;
+                            delete fragment;
+                            fragment = next_fragment;
+                            if (handover->midi_pins.size() == 0) {
+                                delete handover;
+                                continue;
+                            }
+                            double timeline_ms = play_control->timeline_ms.load();
+                            double first_pin_ms = moveLatePins(handover->midi_pins, timeline_ms);
+                            // Time from being appended until its first pin is played
+                            double first_pin_latency_ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - appended_at).count()
+                                + (first_pin_ms - timeline_ms) / play_control->playing_rate.load();
+                            processing_reporting.total_fragments++;
+                            processing_reporting.total_first_pin_latency += first_pin_latency_ms;
+                            processing_reporting.maximum_first_pin_latency = std::max(processing_reporting.maximum_first_pin_latency, first_pin_latency_ms);
+                            play_control->first_pin_latency_ms.store(first_pin_latency_ms);
+                            if (!handOver(handover)) {
+                                deleteFragments(fragment);
+                                processing_pending.store(false);
+                                return;
                             }
-                        } else {
-                            // Needs to use a pin dummy copy given that their midi parameters may be changed
-                            dict_last.emplace(status_data_byte, MidiPin(pluck_pin));    // Just a dummy copy
-                            ++pin_it; // Only increment if no removal
                         }
                     }
-                    break;
+                    processing_pending.store(false);
+                });
+            }
+
+            // Pinned only now, so that the threads started before, like the processing one, aren't pinned too
+            if (play_control != nullptr && play_control->playing_cpu >= 0 && !setThreadAffinity(play_control->playing_cpu)) {
+                play_control->pinning_failed.store(true);
+                if (verbose) std::cerr << "Unable to pin the playing to the CPU " << play_control->playing_cpu << std::endl;
+            }
+
+            auto playing_start = std::chrono::high_resolution_clock::now();
+            double total_paused_ms = 0.0;   // Pausing isn't Drag
+            // Timeline time is mapped into the playing time, given that the playing rate may change
+            TempoMap tempo_map(play_control != nullptr ? play_control->playing_rate.load() : 1.0);
+            double position_ms = 0.0;       // Timeline time of the last plucked pin
+            auto pin_it = midiToProcess.begin();
+            // A pin led by the latency or the burst of its device may be due before the pins of other devices
+            // ahead of it, so the pins within the longest lead are sent once due and only skipped once reached
+            double maximum_lead_ms = 0.0;
+            for (auto &device : available_midi_devices)
+                maximum_lead_ms = std::max(maximum_lead_ms,
+                    device.getLatency() + (device.getByteTime() > 0.0 ? MAX_BURST_LEAD_MS : 0.0));
+            std::vector<std::list<MidiPin>::iterator> led_pins;    // Already sent, still ahead of pin_it
+            size_t flushed_playing = 0;
+
+            // Looping replays the already processed pins, only the region boundary pins are generated
+            double loop_start_ms = 0.0;
+            double loop_end_ms = -1.0;
+            size_t loop_iterations = 0;     // Multiplied instead of accumulated so that there is no drift
+            double looped_ms = 0.0;         // Time looped by previous loop regions
+            std::list<MidiPin>::iterator loop_first_pin;
+            std::vector<MidiPin> loop_pins;
+
+            // The rawmidi devices write together the messages with the same time
+            auto flushDevices = [&available_midi_devices]() {
+                for (auto &device : available_midi_devices)
+                    device.flushMessages();
+            };
+            // While catching up, an automation pin is superseded by a later one of the same controller already due
+            const bool catching_up = play_control != nullptr && play_control->late_policy == late_policy_catch_up;
+            auto isSuperseded = [&midiToProcess](std::list<MidiPin>::iterator automation_pin, double due_time_ms) {
+                switch (automation_pin->getAction()) {
+                    case action_control_change:
+                        if (!isCurveController(automation_pin->getDataByte(1)))
+                            return false;
+                        break;
+                    case action_key_pressure:
+                    case action_channel_pressure:
                     case action_pitch_bend:
-                    {
-                        unsigned char status_byte = pluck_pin.getStatusByte();
-                        auto& dict_last = pluck_device.statusbyte_last_pins_pitchbend;
+                        break;
+                    default:
+                        return false;   // Notes, clocks and transport are never skipped
+                }
+                // The Control Change and the Key Pressure are superseded by controller and by key
+                const bool by_data_byte = automation_pin->getAction() == action_control_change
+                    || automation_pin->getAction() == action_key_pressure;
+                auto next_pin = std::next(automation_pin);
+                for (size_t pin_i = 0; pin_i < CATCH_UP_LOOKAHEAD && next_pin != midiToProcess.end()
+                        && next_pin->getTime() <= due_time_ms; ++pin_i, ++next_pin) {
+                    if (next_pin->getDevice() == automation_pin->getDevice()
+                            && next_pin->getStatusByte() == automation_pin->getStatusByte()
+                            && (!by_data_byte || next_pin->getDataByte(1) == automation_pin->getDataByte(1)))
+                        return true;
+                }
+                return false;
+            };
+            // Sends the SysEx chunks already due, returning the playing time of the next one, if any
+            const long long no_chunk_us = std::numeric_limits<long long>::max();
+            auto sendSysExChunks = [&available_midi_devices, &playing_start, &flushDevices, no_chunk_us]() {
+                long long next_chunk_us = no_chunk_us;
+                bool chunks_sent = false;
+                for (auto &device : available_midi_devices) {
+                    if (!device.hasSysExChunks())
+                        continue;
+                    if (device.getChunkTime() <= std::chrono::high_resolution_clock::now()) {
+                        device.sendSysExChunk();
+                        chunks_sent = true;
+                    }
+                    if (device.hasSysExChunks())
+                        next_chunk_us = std::min(next_chunk_us, static_cast<long long>(
+                            std::chrono::duration_cast<std::chrono::microseconds>(device.getChunkTime() - playing_start).count()));
+                }
+                if (chunks_sent)
+                    flushDevices();
+                return next_chunk_us;
+            };
 
-                        if (dict_last.find(status_byte) != dict_last.end()) {  // Key found
-                            auto &last_pin_8 = dict_last[status_byte];
-                            if (last_pin_8 != pluck_pin) {
+            while (true) {
 
-                                last_pin_8.setDataByte(1, pluck_pin.getDataByte(1));
-                                last_pin_8.setDataByte(2, pluck_pin.getDataByte(2));
-                                ++pin_it; // Only increment if no removal
-                            } else {
-								pin_it = midiToProcess.erase(pin_it);
-                                ++(play_reporting.total_redundant);
+                bool loop_wrapping = false;
+
+                if (play_control != nullptr) {
+                    if (play_control->stop_playing.load(std::memory_order_relaxed)) {
+                        for (auto &device : available_midi_devices) {
+                            device.releaseNotes();
+                            device.stopClock();
+                        }
+                        flushDevices();
+                        break;
+                    }
+                    if (play_control->flushed_playing.load(std::memory_order_relaxed) != flushed_playing) {
+                        flushed_playing = play_control->flushed_playing.load(std::memory_order_relaxed);
+                        for (auto &device : available_midi_devices) {
+                            device.releaseNotes();
+                            device.stopClock();
+                        }
+                        flushDevices();
+                        // The checkpoints of the dropped pins go with them
+                        while (!checkpoints.empty() && pin_it != midiToProcess.end()
+                                && checkpoints.back().time_ms >= pin_it->getTime())
+                            checkpoints.pop_back();
+                        midiToProcess.erase(pin_it, midiToProcess.end());
+                        pin_it = midiToProcess.end();
+                        led_pins.clear();
+                        // The loop region is set again over the pins left
+                        looped_ms += loop_iterations * (loop_end_ms - loop_start_ms);
+                        loop_iterations = 0;
+                        loop_start_ms = 0.0;
+                        loop_end_ms = -1.0;
+                        loop_pins.clear();
+                        play_control->duration_ms.store(position_ms);
+                        continue;   // Checks the flags again
+                    }
+                    double seek_ms = play_control->seek_ms.exchange(-1.0, std::memory_order_relaxed);
+                    if (seek_ms >= 0.0) {
+                        for (auto &device : available_midi_devices) {
+                            device.releaseNotes();
+                            device.stopClock();     // Song Position Pointer is only accepted while stopped
+                        }
+                        std::vector<MidiPin> chase_pins;
+                        pin_it = seekMidiPins(midiToProcess, checkpoints, seek_ms, chase_pins);
+                        led_pins.clear();
+                        playing_start = std::chrono::high_resolution_clock::now();
+                        tempo_map.resetTempo(seek_ms, -(play_reporting.total_drag + total_paused_ms));
+                        loop_iterations = 0;
+                        looped_ms = 0.0;
+                        position_ms = seek_ms;
+                        for (auto &chase_pin : chase_pins) {
+                            chase_pin.pluckTooth();
+                            chase_pin.setDelayTime(std::chrono::duration<double, std::milli>(
+                                std::chrono::high_resolution_clock::now() - playing_start).count());
+                            reportDelay(chase_pin);
+                        }
+                        flushDevices();
+                        play_control->played_ms.store(seek_ms, std::memory_order_relaxed);
+                        continue;   // Checks the flags again
+                    }
+                    if (play_control->pause_playing.load(std::memory_order_relaxed)) {
+                        auto pause_start = std::chrono::high_resolution_clock::now();
+                        std::vector<MidiDevice*> paused_clocks;
+                        for (auto &device : available_midi_devices) {
+                            device.releaseNotes();
+                            if (device.stopClock())
+                                paused_clocks.push_back(&device);
+                        }
+                        flushDevices();
+                        while (play_control->pause_playing.load(std::memory_order_relaxed)
+                                && !play_control->stop_playing.load(std::memory_order_relaxed)) {
+                            highResolutionSleep(CONTROL_POLLING_US);
+                        }
+                        if (!play_control->stop_playing.load(std::memory_order_relaxed)) {
+                            for (auto paused_clock : paused_clocks) {
+                                std::vector<unsigned char> clock_continue_message = { system_clock_continue };
+                                paused_clock->sendMessage(&clock_continue_message);
                             }
-                        } else {
-                            // Needs to use a pin dummy copy given that their midi parameters may be changed
-                            dict_last.emplace(status_byte, MidiPin(pluck_pin));    // Just a dummy copy
-                            ++pin_it; // Only increment if no removal
+                            flushDevices();
                         }
+                        total_paused_ms += std::chrono::duration<double, std::milli>(
+                            std::chrono::high_resolution_clock::now() - pause_start).count();
+                        continue;   // Checks the flags again
                     }
-                    break;
-                    case action_channel_pressure:
-                    {
-                        unsigned char dict_key = pluck_pin.getStatusByte();
-                        auto& dict_last = pluck_device.statusbyte_last_pins_pitchbend;
 
-                        if (dict_last.find(dict_key) != dict_last.end()) {  // Key found
-                            auto &last_pin_8 = dict_last[dict_key];
-                            if (last_pin_8 != pluck_pin) {
+                    double new_loop_start_ms = play_control->loop_start_ms.load(std::memory_order_relaxed);
+                    double new_loop_end_ms = play_control->loop_end_ms.load(std::memory_order_relaxed);
+                    if (new_loop_start_ms != loop_start_ms || new_loop_end_ms != loop_end_ms) {
+                        // The time already looped stays as an offset of the new loop region
+                        looped_ms += loop_iterations * (loop_end_ms - loop_start_ms);
+                        loop_iterations = 0;
+                        loop_start_ms = new_loop_start_ms;
+                        loop_end_ms = new_loop_end_ms;
+                        loop_pins.clear();
+                        if (loop_end_ms > loop_start_ms) {
+                            // Region boundary pins, the ones at its end followed by the ones chasing its start
+                            std::unordered_map<MidiDevice*, MidiState> device_states;
+                            seekMidiStates(midiToProcess, checkpoints, loop_end_ms, device_states);
+                            for (auto &device_state : device_states)
+                                device_state.second.releaseState(device_state.first, loop_end_ms, loop_pins);
+                            loop_first_pin = seekMidiPins(midiToProcess, checkpoints, loop_start_ms, loop_pins);
+                        }
+                    }
+                    double playing_rate = play_control->playing_rate.load(std::memory_order_relaxed);
+                    if (playing_rate > 0.0 && playing_rate != tempo_map.getPlayingRate()) {
+                        // The new rate applies from the current playing time onwards
+                        double playing_ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::high_resolution_clock::now() - playing_start).count();
+                        tempo_map.setPlayingRate(
+                            tempo_map.getTimelineTime(playing_ms - play_reporting.total_drag - total_paused_ms), playing_rate);
+                    }
+                    if (streaming_input) {
+                        // Current timeline time, the fragments being appended shall be later than this
+                        double playing_ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::high_resolution_clock::now() - playing_start).count();
+                        play_control->timeline_ms.store(
+                            tempo_map.getTimelineTime(playing_ms - play_reporting.total_drag - total_paused_ms)
+                                - looped_ms - loop_iterations * (loop_end_ms - loop_start_ms), std::memory_order_relaxed);
+                    }
 
-                                last_pin_8.setDataByte(1, pluck_pin.getDataByte(1));
-                                ++pin_it; // Only increment if no removal
-                            } else {
-								pin_it = midiToProcess.erase(pin_it);
-                                ++(play_reporting.total_redundant);
-                            }
+                    MidiHandover *handover = midi_handover.exchange(nullptr);
+                    if (handover != nullptr && handover->flushed_playing != flushed_playing) {
+                        delete handover;    // Processed before the last flush
+                        handover = nullptr;
+                    }
+                    if (handover != nullptr) {
+                        bool pins_ended = pin_it == midiToProcess.end();
+                        auto first_pin = handover->midi_pins.begin();
+                        if (midiToProcess.size() == 0 || handover->midi_pins.front().getTime() >= midiToProcess.back().getTime()) {
+                            // Appended right after the last pin, so it's seamless as long as it arrives before it
+                            midiToProcess.splice(midiToProcess.end(), handover->midi_pins);
+                            checkpoints.insert(checkpoints.end(), handover->checkpoints.begin(), handover->checkpoints.end());
                         } else {
-                            // Needs to use a pin dummy copy given that their midi parameters may be changed
-                            dict_last.emplace(dict_key, MidiPin(pluck_pin));    // Just a dummy copy
-                            ++pin_it; // Only increment if no removal
+                            // Merged with the pins still to be played, the played ones are kept as they are
+                            std::list<MidiPin> pending_pins;
+                            pending_pins.splice(pending_pins.end(), midiToProcess, pin_it, midiToProcess.end());
+                            pending_pins.merge(handover->midi_pins, [](const MidiPin &a, const MidiPin &b) {
+                                return a.getTime() < b.getTime() || (a.getTime() == b.getTime() && a.getPriority() < b.getPriority());
+                            });
+                            first_pin = pending_pins.begin();
+                            midiToProcess.splice(midiToProcess.end(), pending_pins);
+                            pins_ended = true;  // pin_it was moved and shall now point to the first pending pin
+                            // The checkpoints after the merged pins have stale states, seeking there scans from an earlier one
+                            while (!checkpoints.empty() && checkpoints.back().time_ms >= first_pin->getTime())
+                                checkpoints.pop_back();
+                        }
+                        if (pins_ended)
+                            pin_it = first_pin;
+                        play_control->duration_ms.store(midiToProcess.back().getTime());
+                        delete handover;
+                        if (streaming_input) {
+                            // Only the pins that seeking back and looping may still reach are kept
+                            double keep_ms = position_ms - STREAMING_RETENTION_MS;
+                            if (loop_end_ms > loop_start_ms)
+                                keep_ms = std::min(keep_ms, loop_start_ms);
+                            trimMidiPins(midiToProcess, checkpoints, keep_ms);
                         }
                     }
-                    break;
 
-                    default:    // Includes Program Change 0xC0 (Never considered redundant!)
-                        ++pin_it; // Only increment if no removal
-                    break;
+                    loop_wrapping = loop_end_ms > loop_start_ms && position_ms < loop_end_ms
+                        && (pin_it == midiToProcess.end() || pin_it->getTime() >= loop_end_ms);
                 }
 
-            skip_to_next_pin: ;	// Does nothing, just processes next pin
-            }
+                const long long next_chunk_us = sendSysExChunks();
 
-            // Get time_ms of last message
-            auto last_message_time_ms = midiToProcess.back().getTime();
-            
-            
-            for (auto &device : available_midi_devices) {
-                
-                if (device.hasPortOpen()) {
-                    
-                    // MIDI NOTES SHALL NOT BE LEFT PRESSED !!
-                    // Add the needed note off for all those still on at the end!
-                    // Iterate over all keys and values
-                    for (const auto& pair : device.channelpitch_last_pins_note_on) {
-                        // uint16_t channel_pitch = pair.first;
-                        auto& last_pin_note_on = pair.second;
-
-                        if (last_pin_note_on->getNotePressedTimes() > 0) {
-                            // Transform midi on in midi off
-                            std::vector<unsigned char> midi_pin_message = {
-                                static_cast<unsigned char>(last_pin_note_on->getChannel() | action_note_off),    // note_off_status_byte
-                                last_pin_note_on->getDataByte(1),
-                                0	// Note off has velocity 0 (Data Byte 2)
-                            };
-                            // Adds a new MidiPin as a copy to the list of pins to be processed
-                            midiToProcess.push_back( MidiPin(last_message_time_ms, &device, midi_pin_message) );
-                            play_reporting.total_generated++;
-                        }
+                if (pin_it == midiToProcess.end() && !loop_wrapping) {
+                    // Pending is read before the handover so that the last file handed over is never missed
+                    if (processing_pending.load() || midi_handover.load() != nullptr) {
+                        highResolutionSleep(CONTROL_POLLING_US);
+                        continue;   // Waits for the next file being processed
                     }
-
-                    // LAST MIDI CLOCK MESSAGE SHALL BE STOP
-                    if (device.last_pin_clock != nullptr && device.last_pin_clock->getStatusByte() == system_timing_clock)
-                        device.last_pin_clock->setStatusByte(system_clock_stop);    // Clock Stop
+                    if (next_chunk_us != no_chunk_us) {
+                        long long chunk_wait_us = next_chunk_us - std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::high_resolution_clock::now() - playing_start).count();
+                        highResolutionSleep(std::clamp<long long>(chunk_wait_us, 0, CONTROL_POLLING_US));
+                        continue;   // Waits for the last SysEx being sent
+                    }
+                    break;
                 }
-            }
-
-            #ifdef DEBUGGING
-            debugging_now = std::chrono::high_resolution_clock::now();
-            completion_time = std::chrono::duration_cast<std::chrono::microseconds>(debugging_now - debugging_last);
-            completion_time_us = completion_time.count();
-            std::cout << "MIDI MESSAGES CLEANING UP FULLY PROCESSED IN: " << completion_time_us << " microseconds" << std::endl;
-            debugging_last = std::chrono::high_resolution_clock::now();
-            #endif
-
-            auto data_processing_finish = std::chrono::high_resolution_clock::now();
-            auto data_processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(data_processing_finish - data_processing_start);
-
-            play_reporting.json_processing = data_processing_time.count();
-
-            // Where the reporting is finally done
-            if (verbose) std::cout << "Data stats reporting:" << std::endl;
-            if (verbose) std::cout << "\tMidi Messages processing time (ms):       " << std::setw(10) << play_reporting.json_processing << std::endl;
-            if (verbose) std::cout << "\tTotal generated Midi Messages (included): " << std::setw(10) << play_reporting.total_generated << std::endl;
-            if (verbose) std::cout << "\tTotal validated Midi Messages (accepted): " << std::setw(10) << play_reporting.total_validated << std::endl;
-            if (verbose) std::cout << "\tTotal incorrect Midi Messages (excluded): " << std::setw(10) << play_reporting.total_incorrect << std::endl;
-            if (verbose) std::cout << "\tTotal redundant Midi Messages (excluded): " << std::setw(10) << play_reporting.total_redundant << std::endl;
-            if (verbose) std::cout << "\tTotal resultant Midi Messages (included): " << std::setw(10) << midiToProcess.size() << std::endl;
-
-            MidiPin *last_pin = &midiToProcess.back();
-            size_t duration_time_sec = std::round(last_pin->getTime() / 1000);
-            if (verbose) std::cout << "The data will now be played during "
-                << duration_time_sec / 60 << " minutes and " << duration_time_sec % 60 << " seconds..." << std::endl;
-
-            //
-            // Where the Midi messages are sent to each Device
-            //
-
-            auto playing_start = std::chrono::high_resolution_clock::now();
 
-            while (midiToProcess.size() > 0) {
+                if (!loop_wrapping && !led_pins.empty()) {
+                    auto led_pin = std::find(led_pins.begin(), led_pins.end(), pin_it);
+                    if (led_pin != led_pins.end()) {
+                        led_pins.erase(led_pin);
+                        position_ms = pin_it->getTime();
+                        if (play_control != nullptr) play_control->played_ms.store(position_ms, std::memory_order_relaxed);
+                        ++pin_it;
+                        if (pin_it == midiToProcess.end() || pin_it->getTime() != position_ms)
+                            flushDevices();
+                        continue;   // Already sent
+                    }
+                }
                 
-                MidiPin &midi_pin = midiToProcess.front();  // Pin MIDI message
-
-                long long next_pin_time_us = std::round((midi_pin.getTime() + play_reporting.total_drag) * 1000);
+                const double next_time_ms = loop_wrapping ? loop_end_ms : pin_it->getTime();
+                const double loop_offset_ms = looped_ms + loop_iterations * (loop_end_ms - loop_start_ms);
+
+                const double lead_time_ms = loop_wrapping ? 0.0 : pin_it->getLeadTime();
+
+                long long next_pin_time_us = std::round(
+                    (tempo_map.getPlayingTime(next_time_ms + loop_offset_ms) - lead_time_ms
+                        + play_reporting.total_drag + total_paused_ms) * 1000);
+
+                // The earliest due of the pins within the longest lead, being pin_it the one of the same due
+                auto due_pin = pin_it;
+                if (!loop_wrapping && maximum_lead_ms > 0.0) {
+                    const double lead_window_ms = tempo_map.getPlayingTime(next_time_ms + loop_offset_ms) + maximum_lead_ms;
+                    for (auto ahead_pin = std::next(pin_it); ahead_pin != midiToProcess.end(); ++ahead_pin) {
+                        if (loop_end_ms > loop_start_ms && position_ms < loop_end_ms && ahead_pin->getTime() >= loop_end_ms)
+                            break;  // Only played after the loop region
+                        const double ahead_playing_ms = tempo_map.getPlayingTime(ahead_pin->getTime() + loop_offset_ms);
+                        if (ahead_playing_ms > lead_window_ms)
+                            break;
+                        long long ahead_pin_time_us = std::round((ahead_playing_ms - ahead_pin->getLeadTime()
+                            + play_reporting.total_drag + total_paused_ms) * 1000);
+                        if (ahead_pin_time_us < next_pin_time_us
+                                && std::find(led_pins.begin(), led_pins.end(), ahead_pin) == led_pins.end()) {
+                            due_pin = ahead_pin;
+                            next_pin_time_us = ahead_pin_time_us;
+                        }
+                    }
+                }
                 auto playing_now = std::chrono::high_resolution_clock::now();
                 auto elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(playing_now - playing_start);
                 long long elapsed_time_us = elapsed_time.count();
                 long long sleep_time_us = next_pin_time_us > elapsed_time_us ? next_pin_time_us - elapsed_time_us : 0;
 
+                if (next_chunk_us < next_pin_time_us) {
+                    highResolutionSleep(std::clamp<long long>(next_chunk_us - elapsed_time_us, 0, CONTROL_POLLING_US));
+                    continue;   // The chunks due before the pin are sent first
+                }
+
+                if (play_control != nullptr && sleep_time_us > CONTROL_POLLING_US) {
+                    highResolutionSleep(CONTROL_POLLING_US);
+                    continue;   // Keeps stop and pause responsive during long waits
+                }
+
                 highResolutionSleep(sleep_time_us);  // Sleep for x microseconds
 
-                auto pluck_time = std::chrono::high_resolution_clock::now() - playing_start;
-                midi_pin.pluckTooth();  // as soon as possible! <----- Midi Send
+                if (loop_wrapping) {
+                    for (auto &loop_pin : loop_pins) {
+                        double delay_time_ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::high_resolution_clock::now() - playing_start).count() - next_pin_time_us / 1000.0;
+                        loop_pin.pluckTooth(delay_time_ms);
+                        loop_pin.setDelayTime(delay_time_ms);
+                        reportDelay(loop_pin);
+                    }
+                    flushDevices();
+                    pin_it = loop_first_pin;
+                    loop_iterations++;
+                    position_ms = loop_start_ms;
+                    play_control->played_ms.store(loop_start_ms, std::memory_order_relaxed);
+                    continue;
+                }
 
+                MidiPin &midi_pin = *pin_it;  // Pin MIDI message
+
+                auto pluck_time = std::chrono::high_resolution_clock::now() - playing_start;
                 auto pluck_time_us = static_cast<double>(
                     std::chrono::duration_cast<std::chrono::microseconds>(pluck_time).count()
                 );
                 double delay_time_ms = (pluck_time_us - next_pin_time_us) / 1000;
-                midi_pin.setDelayTime(delay_time_ms);
-                midiProcessed.push_back(std::move(midiToProcess.front()));  // Move the object
-                midiToProcess.pop_front();  // Remove the first element
+                if (due_pin != pin_it) {
+                    // Sent ahead of the pins before it in the timeline, its position is only played once reached
+                    due_pin->pluckTooth(delay_time_ms);
+                    due_pin->setDelayTime(delay_time_ms);
+                    reportDelay(*due_pin);
+                    led_pins.push_back(due_pin);
+                    flushDevices();
+                    if (!catching_up && delay_time_ms > DRAG_DURATION_MS)
+                        play_reporting.total_drag += delay_time_ms - DRAG_DURATION_MS;
+                    continue;
+                }
+                if (catching_up && delay_time_ms > 0.0) {
+                    const double due_time_ms = tempo_map.getTimelineTime(
+                        pluck_time_us / 1000 - play_reporting.total_drag - total_paused_ms) - loop_offset_ms;
+                    if (isSuperseded(pin_it, due_time_ms)) {
+                        play_reporting.total_superseded++;
+                        position_ms = midi_pin.getTime();
+                        play_control->played_ms.store(position_ms, std::memory_order_relaxed);
+                        ++pin_it;
+                        if (pin_it == midiToProcess.end() || pin_it->getTime() != position_ms)
+                            flushDevices();
+                        continue;
+                    }
+                }
+                midi_pin.pluckTooth(delay_time_ms);  // as soon as possible! <----- Midi Send
 
-                // Process drag if existent
-                if (delay_time_ms > DRAG_DURATION_MS)
+                midi_pin.setDelayTime(delay_time_ms);
+                position_ms = midi_pin.getTime();
+                if (play_control != nullptr) play_control->played_ms.store(position_ms, std::memory_order_relaxed);
+                reportDelay(midi_pin);
+                ++pin_it;
+                if (pin_it == midiToProcess.end() || pin_it->getTime() != position_ms)
+                    flushDevices();
+
+                // Process drag if existent, catching up keeps the timeline instead
+                if (!catching_up && delay_time_ms > DRAG_DURATION_MS)
                     play_reporting.total_drag += delay_time_ms - DRAG_DURATION_MS;  // Drag isn't Delay
             }
 
+            for (auto &device : available_midi_devices)
+                device.finishSysEx();   // Like when stopped
+            flushDevices();
+            playing_finished.store(true);
+            if (processing_thread.joinable())
+                processing_thread.join();
+            // No port is opened from now on, so each worker is drained for good
+            device_resolver.waitOpenings();
+            for (auto &device : available_midi_devices)
+                device.drainOutput();   // Their reporting is only complete once drained
+            delete midi_handover.exchange(nullptr);
+            play_reporting.total_generated += processing_reporting.total_generated;
+            play_reporting.total_validated += processing_reporting.total_validated;
+            play_reporting.total_incorrect += processing_reporting.total_incorrect;
+            play_reporting.total_redundant += processing_reporting.total_redundant;
+            play_reporting.total_thinned += processing_reporting.total_thinned;
+            play_reporting.total_saturated += processing_reporting.total_saturated;
+            play_reporting.maximum_saturation = std::max(play_reporting.maximum_saturation, processing_reporting.maximum_saturation);
+            play_reporting.total_late = processing_reporting.total_late;
+            play_reporting.total_lateness = processing_reporting.total_lateness;
+            play_reporting.maximum_lateness = processing_reporting.maximum_lateness;
+            play_reporting.total_fragments = processing_reporting.total_fragments;
+            play_reporting.total_first_pin_latency = processing_reporting.total_first_pin_latency;
+            play_reporting.maximum_first_pin_latency = processing_reporting.maximum_first_pin_latency;
+
             #ifdef DEBUGGING
             debugging_now = std::chrono::high_resolution_clock::now();
             completion_time = std::chrono::duration_cast<std::chrono::microseconds>(debugging_now - debugging_last);
@@ -986,25 +2837,34 @@ int PlayList(const char* json_str, bool verbose) {
             // Where the final Statistics are calculated
             //
 
-            if (midiProcessed.size() > 0) {
-
-                for (auto &midi_pin : midiProcessed) {
-                    auto delay_time_ms = midi_pin.getDelayTime();
-                    play_reporting.total_delay += delay_time_ms;
-                    play_reporting.maximum_delay = std::max(play_reporting.maximum_delay, delay_time_ms);
-                }
+            if (total_played > 0) {
 
-                play_reporting.minimum_delay = play_reporting.maximum_delay;
-                play_reporting.average_delay = play_reporting.total_delay / midiProcessed.size();
+                play_reporting.sd_delay = std::sqrt(squared_deviations / total_played);
 
-                for (auto &midi_pin : midiProcessed) {
-                    auto delay_time_ms = midi_pin.getDelayTime();
-                    play_reporting.minimum_delay = std::min(play_reporting.minimum_delay, delay_time_ms);
-                    play_reporting.sd_delay += std::pow(delay_time_ms - play_reporting.average_delay, 2);
+                // Per device and per message class breakdown, kept in the devices listing order
+                for (auto &device : available_midi_devices) {
+                    if (device.hasPortOpen()) {
+                        devices_reporting.push_back({ device.getName(), {},
+                            device.getByteStreamReporting(), device.getOutputReporting() });
+                        auto device_classes = classes_reporting.find(&device);
+                        if (device_classes != classes_reporting.end())
+                            devices_reporting.back().message_classes = std::move(device_classes->second);
+                        play_reporting.total_fragmented_sysex += device.getByteStreamReporting().fragmented_sysex;
+                        play_reporting.total_sysex_chunks += device.getByteStreamReporting().sent_chunks;
+                    }
                 }
 
-                play_reporting.sd_delay /= midiProcessed.size();
-                play_reporting.sd_delay = std::sqrt(play_reporting.sd_delay);
+                for (auto &device_reporting : devices_reporting) {
+                    for (auto &class_reporting : device_reporting.message_classes) {
+                        auto &delays = class_reporting.delays;
+                        if (delays.size() > 0) {
+                            std::sort(delays.begin(), delays.end());
+                            // Nearest rank percentiles
+                            class_reporting.p95_delay = delays[static_cast<size_t>(std::ceil(0.95 * delays.size())) - 1];
+                            class_reporting.p99_delay = delays[static_cast<size_t>(std::ceil(0.99 * delays.size())) - 1];
+                        }
+                    }
+                }
             }
         }
         
@@ -1022,12 +2882,121 @@ int PlayList(const char* json_str, bool verbose) {
     if (verbose) std::cout << "\tMinimum delay (ms): " << std::setw(36) << play_reporting.minimum_delay << " /" << std::endl;
     if (verbose) std::cout << "\tAverage delay (ms): " << std::setw(36) << play_reporting.average_delay << " \\" << std::endl;
     if (verbose) std::cout << "\tStandard deviation of delays (ms):" << std::setw(36 - 14) << play_reporting.sd_delay << " /"  << std::endl;
+    if (verbose && play_reporting.total_superseded > 0)
+        std::cout << "\tTotal superseded Midi Messages (skipped): " << std::setw(14) << play_reporting.total_superseded << std::endl;
+    if (verbose && play_reporting.total_fragmented_sysex > 0)
+        std::cout << "\tTotal SysEx sent by chunks (chunks): " << std::setw(19) << play_reporting.total_fragmented_sysex
+            << " (" << play_reporting.total_sysex_chunks << ")" << std::endl;
+
+    if (verbose && (play_reporting.total_fragments > 0 || play_reporting.total_late > 0)) {
+        std::cout << "Streaming stats reporting:" << std::endl;
+        std::cout << "\tTotal appended fragments (played): " << std::setw(21) << play_reporting.total_fragments << std::endl;
+        if (play_reporting.total_fragments > 0) {
+            std::cout << "\tAverage latency to first pin (ms): " << std::setw(21)
+                << play_reporting.total_first_pin_latency / play_reporting.total_fragments << " \\" << std::endl;
+            std::cout << "\tMaximum latency to first pin (ms): " << std::setw(21) << play_reporting.maximum_first_pin_latency << " /" << std::endl;
+        }
+        std::cout << "\tTotal late Midi Messages (moved): " << std::setw(22) << play_reporting.total_late << std::endl;
+        if (play_reporting.total_late > 0) {
+            std::cout << "\tAverage lateness (ms): " << std::setw(33) << play_reporting.total_lateness / play_reporting.total_late << " \\" << std::endl;
+            std::cout << "\tMaximum lateness (ms): " << std::setw(33) << play_reporting.maximum_lateness << " /" << std::endl;
+        }
+    }
+
+    if (verbose && devices_reporting.size() > 0) {
+        const char* message_class_names[total_message_classes] = {
+            "Clock", "Note", "Control Change", "Pitch Bend", "SysEx", "Transport", "Other"
+        };
+        std::cout << "Devices stats reporting (ms):" << std::endl;
+        for (auto &device_reporting : devices_reporting) {
+            std::cout << "\t" << device_reporting.device_name << std::endl;
+            std::cout << "\t\t" << std::left << std::setw(16) << "Class" << std::right
+                << std::setw(10) << "Messages" << std::setw(10) << "Bytes"
+                << std::setw(10) << "Average" << std::setw(10) << "p95" << std::setw(10) << "p99"
+                << std::setw(10) << "Maximum" << std::setw(10) << "Drag" << std::endl;
+            for (unsigned char message_class = 0; message_class < total_message_classes; message_class++) {
+                auto &class_reporting = device_reporting.message_classes[message_class];
+                if (class_reporting.total_messages == 0)
+                    continue;
+                std::cout << "\t\t" << std::left << std::setw(16) << message_class_names[message_class] << std::right
+                    << std::setw(10) << class_reporting.total_messages
+                    << std::setw(10) << class_reporting.total_bytes
+                    << std::setw(10) << class_reporting.total_delay / class_reporting.total_messages
+                    << std::setw(10) << class_reporting.p95_delay
+                    << std::setw(10) << class_reporting.p99_delay
+                    << std::setw(10) << class_reporting.maximum_delay
+                    << std::setw(10) << class_reporting.total_drag << std::endl;
+            }
+            // Clock delays on the port itself, given by the bytes sent before each clock, like the SysEx chunks
+            auto &byte_stream = device_reporting.byte_stream;
+            if (byte_stream.total_clocks > 0) {
+                double average_wire_delay = byte_stream.total_clock_wire_delay / byte_stream.total_clocks;
+                double wire_jitter = std::sqrt(std::max(0.0,
+                    byte_stream.squared_clock_wire_delay / byte_stream.total_clocks - average_wire_delay * average_wire_delay));
+                std::cout << "\t\tClock delays on the port: average " << average_wire_delay
+                    << ", jitter " << wire_jitter << ", maximum " << byte_stream.maximum_clock_wire_delay << std::endl;
+            }
+            if (byte_stream.fragmented_sysex > 0) {
+                std::cout << "\t\tSysEx sent by chunks: " << byte_stream.fragmented_sysex
+                    << " (" << byte_stream.sent_chunks << " chunks)" << std::endl;
+            }
+            // Written by its own worker, being these delays the ones of the port alone
+            auto &output = device_reporting.output;
+            if (output.total_messages > 0) {
+                std::cout << "\t\tOutput queue delays: average " << output.total_queue_delay / output.total_messages
+                    << ", maximum " << output.maximum_queue_delay << std::endl;
+            }
+            if (output.dropped_messages > 0 || output.failed_messages > 0) {
+                std::cout << "\t\tOutput messages lost: " << output.dropped_messages << " by a full queue, "
+                    << output.failed_messages << " by the port" << std::endl;
+            }
+        }
+    }
 
 
     return 0;
 }
 
 
+int PlayList(const char* json_str, bool verbose, PlayControl *play_control) {
+    return playInput([json_str, verbose](MidiDeviceResolver &device_resolver) {
+        return readJsonFiles(reinterpret_cast<const unsigned char*>(json_str), std::strlen(json_str), format_json, verbose,
+                                &device_resolver);
+    }, nullptr, verbose, play_control);
+}
+
+int PlayData(const unsigned char* input_data, size_t input_size, bool verbose, PlayControl *play_control) {
+    return playInput([input_data, input_size, verbose](MidiDeviceResolver &device_resolver) {
+        return readJsonFiles(input_data, input_size, format_detect, verbose, &device_resolver);
+    }, nullptr, verbose, play_control);
+}
+
+int PlayEvents(const MidiEventsData &events_data, bool verbose, PlayControl *play_control) {
+    if (events_data.device_names == nullptr && events_data.total_devices > 0)
+        return EXIT_FAILURE;    // No names to index by the events devices
+    return playInput([](MidiDeviceResolver&) { return std::vector<JsonFile>(); }, &events_data, verbose, play_control);
+}
+
+int PlayInput(const std::vector<InputDocument> &input_documents, const MidiEventsData *events_data,
+                bool verbose, PlayControl *play_control) {
+    return playInput([&input_documents, verbose](MidiDeviceResolver &device_resolver) {
+        // A document that isn't valid is left out without affecting the other ones
+        std::vector<JsonFile> json_files;
+        for (const InputDocument &input_document : input_documents) {
+            try {
+                std::vector<JsonFile> document_files = readJsonFiles(
+                    reinterpret_cast<const unsigned char*>(input_document.input_data.data()),
+                    input_document.input_data.size(), input_document.input_format, verbose, &device_resolver);
+                std::move(document_files.begin(), document_files.end(), std::back_inserter(json_files));
+            } catch (const nlohmann::json::exception& e) {
+                if (verbose) std::cerr << "JSON parse error: " << e.what() << std::endl;
+            }
+        }
+        return json_files;
+    }, events_data, verbose, play_control);
+}
+
+
 
 void disableBackgroundThrottling() {
 #ifdef _WIN32
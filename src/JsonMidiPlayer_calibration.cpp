@@ -0,0 +1,145 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#include "JsonMidiPlayer_calibration.hpp"
+
+#include <iomanip>
+
+
+// Filled by the RtMidiIn thread
+struct ProbeReturns {
+    std::mutex returns_mutex;
+    std::condition_variable probe_returned;
+    std::vector<std::chrono::steady_clock::time_point> return_times;  // Of each probe, the epoch while not returned
+};
+
+static std::vector<unsigned char> probeMessage(size_t probe_i) {
+    return { 0xF0, 0x7D, 'J', 'M', static_cast<unsigned char>(probe_i >> 7 & 0x7F),
+                static_cast<unsigned char>(probe_i & 0x7F), 0xF7 };
+}
+
+static void receiveProbe(double /*delta_time*/, std::vector<unsigned char> *midi_message, void *probe_returns_data) {
+    const auto return_time = std::chrono::steady_clock::now();
+    const std::vector<unsigned char> &message = *midi_message;
+    if (message.size() != 7 || message[0] != 0xF0 || message[1] != 0x7D || message[2] != 'J' || message[3] != 'M')
+        return;     // Anything else coming in on the same port
+    ProbeReturns *probe_returns = static_cast<ProbeReturns*>(probe_returns_data);
+    const size_t probe_i = static_cast<size_t>(message[4]) << 7 | message[5];
+    {
+        std::lock_guard<std::mutex> lock(probe_returns->returns_mutex);
+        if (probe_i >= probe_returns->return_times.size()
+                || probe_returns->return_times[probe_i] != std::chrono::steady_clock::time_point())
+            return;
+        probe_returns->return_times[probe_i] = return_time;
+    }
+    probe_returns->probe_returned.notify_one();
+}
+
+bool measureRoundTrip(const std::string &output_name, const std::string &input_name,
+                        RoundTripReporting &round_trip, size_t total_probes) {
+    total_probes = std::min<size_t>(total_probes, 0x3FFF);  // The index has 14 bits
+    try {
+        RtMidiOut midiOut;
+        RtMidiIn midiIn;
+        unsigned int output_port = midiOut.getPortCount();
+        for (unsigned int port_i = 0; port_i < midiOut.getPortCount(); port_i++) {
+            if (midiOut.getPortName(port_i).find(output_name) != std::string::npos) {
+                output_port = port_i;
+                break;
+            }
+        }
+        unsigned int input_port = midiIn.getPortCount();
+        for (unsigned int port_i = 0; port_i < midiIn.getPortCount(); port_i++) {
+            if (midiIn.getPortName(port_i).find(input_name) != std::string::npos) {
+                input_port = port_i;
+                break;
+            }
+        }
+        if (output_port == midiOut.getPortCount() || input_port == midiIn.getPortCount())
+            return false;
+        round_trip.output_port = midiOut.getPortName(output_port);
+        round_trip.input_port = midiIn.getPortName(input_port);
+
+        ProbeReturns probe_returns;
+        probe_returns.return_times.resize(total_probes);
+        midiIn.ignoreTypes(false, true, true);  // Takes the SysEx, the only probes
+        midiIn.setCallback(receiveProbe, &probe_returns);
+        midiIn.openPort(input_port);
+        midiOut.openPort(output_port);
+
+        std::vector<double> round_trips_ms;
+        for (size_t probe_i = 0; probe_i < total_probes; probe_i++) {
+            std::vector<unsigned char> probe_message = probeMessage(probe_i);
+            const auto sent_time = std::chrono::steady_clock::now();
+            midiOut.sendMessage(&probe_message);
+            std::unique_lock<std::mutex> lock(probe_returns.returns_mutex);
+            const bool returned = probe_returns.probe_returned.wait_until(lock,
+                sent_time + std::chrono::microseconds(static_cast<long long>(CALIBRATION_TIMEOUT_MS * 1000)),
+                [&probe_returns, probe_i]() {
+                    return probe_returns.return_times[probe_i] != std::chrono::steady_clock::time_point();
+                });
+            if (returned)
+                round_trips_ms.push_back(std::chrono::duration<double, std::milli>(
+                    probe_returns.return_times[probe_i] - sent_time).count());
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(CALIBRATION_INTERVAL_MS * 1000)));
+        }
+        midiIn.cancelCallback();    // Before probe_returns is gone
+        midiIn.closePort();
+        midiOut.closePort();
+
+        round_trip.total_probes = total_probes;
+        round_trip.total_returned = round_trips_ms.size();
+        if (round_trips_ms.size() > 0) {
+            std::sort(round_trips_ms.begin(), round_trips_ms.end());
+            round_trip.minimum_ms = round_trips_ms.front();
+            round_trip.median_ms = round_trips_ms[round_trips_ms.size() / 2];
+            round_trip.maximum_ms = round_trips_ms.back();
+        }
+    } catch (RtMidiError &error) {
+        error.printMessage();
+        return false;
+    }
+    return true;
+}
+
+int CalibrateLatency(const char* loopback_ports, bool verbose) {
+    const char *comma = std::strchr(loopback_ports, ',');
+    if (comma == nullptr) {
+        std::cerr << "The loopback shall be given as output_name,input_name" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string output_name(loopback_ports, comma);
+    const std::string input_name(comma + 1);
+    RoundTripReporting round_trip;
+    if (!measureRoundTrip(output_name, input_name, round_trip)) {
+        std::cerr << "No output port containing \"" << output_name << "\" and input port containing \""
+                  << input_name << "\" to loop through" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (verbose) std::cout << "Looping from " << round_trip.output_port << " to " << round_trip.input_port << std::endl;
+    std::cout << "Returned probes: " << round_trip.total_returned << " of " << round_trip.total_probes << std::endl;
+    if (round_trip.total_returned == 0) {
+        std::cerr << "No probe came back, the ports may not be looped or drop the SysEx" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::fixed << std::setprecision(3)
+              << "Round trip (ms): minimum " << round_trip.minimum_ms << ", median " << round_trip.median_ms
+              << ", maximum " << round_trip.maximum_ms << std::endl;
+    // The way out and the way back through the same interface take about the same time
+    std::cout << "Output latency to compensate (ms): " << round_trip.median_ms / 2
+              << ", like --latency \"" << output_name << "=" << round_trip.median_ms / 2 << "\"" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -14,11 +14,208 @@ https://github.com/ruiseixasm/JsonMidiCreator
 https://github.com/ruiseixasm/JsonMidiPlayer
 */
 #include "JsonMidiPlayer_ctypes.hpp"
+#include "JsonMidiPlayer_shm.hpp"
+#include "JsonMidiPlayer_smf.hpp"
 
 int PlayList_ctypes(const char* json_str, int verbose) {
     return PlayList(json_str, verbose);
 }
 
+
+// Keeps its own copy of the json string given that the caller's one may be freed meanwhile
+struct PlayHandle {
+    std::string json_str;   // Or its CBOR or MessagePack bytes
+    PlayControl play_control;
+    std::thread play_thread;
+    int play_result = 0;
+    std::string shm_name;   // Of the shared memory ring, if any
+    std::vector<MidiEventRecord> events;    // Of the binary events, if any
+    std::vector<std::string> device_names;
+    std::vector<const char*> device_names_table;
+    std::vector<unsigned char> sysex_data;
+};
+
+static void startPlaying(PlayHandle *play_handle, int verbose) {
+    play_handle->play_thread = std::thread([play_handle, verbose]() {
+        try {
+            if (!play_handle->events.empty()) {
+                MidiEventsData events_data = {
+                    play_handle->events.data(), play_handle->events.size(),
+                    play_handle->device_names_table.data(), play_handle->device_names_table.size(),
+                    play_handle->sysex_data.data(), play_handle->sysex_data.size()
+                };
+                play_handle->play_result = PlayEvents(events_data, verbose, &play_handle->play_control);
+            } else
+                play_handle->play_result = PlayData(reinterpret_cast<const unsigned char*>(play_handle->json_str.data()),
+                    play_handle->json_str.size(), verbose, &play_handle->play_control);
+        } catch (const std::exception& e) {    // Shall never escape the thread
+            if (verbose) std::cerr << "Error: " << e.what() << std::endl;
+            play_handle->play_result = EXIT_FAILURE;
+        }
+        play_handle->play_control.finished_playing.store(true);
+    });
+}
+
+void* PlayList_start_ctypes(const char* json_str, int verbose) {
+    PlayHandle *play_handle = new PlayHandle();
+    play_handle->json_str = json_str;
+    startPlaying(play_handle, verbose);
+    return play_handle;
+}
+
+int PlayList_data_ctypes(const unsigned char* input_data, size_t input_size, int verbose) {
+    return PlayData(input_data, input_size, verbose);
+}
+
+void* PlayList_data_start_ctypes(const unsigned char* input_data, size_t input_size, int verbose) {
+    PlayHandle *play_handle = new PlayHandle();
+    play_handle->json_str.assign(reinterpret_cast<const char*>(input_data), input_size);
+    startPlaying(play_handle, verbose);
+    return play_handle;
+}
+
+void* PlayList_stream_ctypes(const char* json_str, int verbose) {
+    PlayHandle *play_handle = new PlayHandle();
+    play_handle->json_str = json_str;
+    play_handle->play_control.streaming_input.store(true);
+    startPlaying(play_handle, verbose);
+    return play_handle;
+}
+
+void* PlayList_ring_ctypes(const char* shm_name, int verbose) {
+    ShmRingHeader *shm_ring = createShmRing(shm_name);
+    if (shm_ring == nullptr)
+        return nullptr;
+    PlayHandle *play_handle = new PlayHandle();
+    play_handle->json_str = "[]";
+    play_handle->shm_name = shm_name;
+    play_handle->play_control.shm_ring = shm_ring;
+    play_handle->play_control.streaming_input.store(true);  // Until the producer closes the ring
+    startPlaying(play_handle, verbose);
+    return play_handle;
+}
+
+int PlayList_events_ctypes(const MidiEventRecord* events, size_t total_events,
+                            const char** device_names, size_t total_devices,
+                            const unsigned char* sysex_data, size_t sysex_size, int verbose) {
+    if (device_names == nullptr && total_devices > 0)
+        return EXIT_FAILURE;
+    MidiEventsData events_data = { events, total_events, device_names, total_devices, sysex_data, sysex_size };
+    return PlayEvents(events_data, verbose);
+}
+
+void* PlayList_events_start_ctypes(const MidiEventRecord* events, size_t total_events,
+                                    const char** device_names, size_t total_devices,
+                                    const unsigned char* sysex_data, size_t sysex_size, int verbose) {
+    if (device_names == nullptr && total_devices > 0)
+        return nullptr;
+    PlayHandle *play_handle = new PlayHandle();
+    play_handle->json_str = "[]";
+    play_handle->events.assign(events, events + total_events);
+    for (size_t device_i = 0; device_i < total_devices; ++device_i)
+        play_handle->device_names.push_back(device_names[device_i] != nullptr ? device_names[device_i] : "");
+    for (const std::string &device_name : play_handle->device_names)
+        play_handle->device_names_table.push_back(device_name.c_str());
+    if (sysex_data != nullptr)
+        play_handle->sysex_data.assign(sysex_data, sysex_data + sysex_size);
+    startPlaying(play_handle, verbose);
+    return play_handle;
+}
+
+int PlayList_smf_ctypes(const char* filename, const char* track_devices, int verbose) {
+    SmfEvents smf_events;
+    if (!readSmfFile(filename, splitTrackDevices(track_devices), smf_events))
+        return EXIT_FAILURE;
+    return PlayEvents(smf_events.getEventsData(), verbose);
+}
+
+// Nullptr if the file can't be read
+void* PlayList_smf_start_ctypes(const char* filename, const char* track_devices, int verbose) {
+    SmfEvents smf_events;
+    if (!readSmfFile(filename, splitTrackDevices(track_devices), smf_events))
+        return nullptr;
+    PlayHandle *play_handle = new PlayHandle();
+    play_handle->json_str = "[]";
+    play_handle->events = std::move(smf_events.events);
+    play_handle->device_names = std::move(smf_events.device_names);
+    for (const std::string &device_name : play_handle->device_names)
+        play_handle->device_names_table.push_back(device_name.c_str());
+    play_handle->sysex_data = std::move(smf_events.sysex_data);
+    startPlaying(play_handle, verbose);
+    return play_handle;
+}
+
+void PlayList_append_ctypes(void* play_handle, const char* json_str) {
+    static_cast<PlayHandle*>(play_handle)->play_control.appendFragment(json_str);
+}
+
+void PlayList_append_data_ctypes(void* play_handle, const unsigned char* input_data, size_t input_size) {
+    static_cast<PlayHandle*>(play_handle)->play_control.appendFragment(input_data, input_size);
+}
+
+void PlayList_close_ctypes(void* play_handle) {
+    static_cast<PlayHandle*>(play_handle)->play_control.streaming_input.store(false);
+}
+
+double PlayList_timeline_ctypes(void* play_handle) {
+    return static_cast<PlayHandle*>(play_handle)->play_control.timeline_ms.load();
+}
+
+size_t PlayList_late_ctypes(void* play_handle) {
+    return static_cast<PlayHandle*>(play_handle)->play_control.late_pins.load();
+}
+
+void PlayList_stop_ctypes(void* play_handle) {
+    static_cast<PlayHandle*>(play_handle)->play_control.stop_playing.store(true);
+}
+
+void PlayList_pause_ctypes(void* play_handle) {
+    static_cast<PlayHandle*>(play_handle)->play_control.pause_playing.store(true);
+}
+
+void PlayList_resume_ctypes(void* play_handle) {
+    static_cast<PlayHandle*>(play_handle)->play_control.pause_playing.store(false);
+}
+
+void PlayList_seek_ctypes(void* play_handle, double time_ms) {
+    static_cast<PlayHandle*>(play_handle)->play_control.seek_ms.store(time_ms);
+}
+
+// Looping stops with an end_ms not after the start_ms
+void PlayList_loop_ctypes(void* play_handle, double start_ms, double end_ms) {
+    PlayHandle *handle = static_cast<PlayHandle*>(play_handle);
+    handle->play_control.loop_start_ms.store(start_ms);
+    handle->play_control.loop_end_ms.store(end_ms);
+}
+
+// Changes the playing speed while playing, like 0.5 for half the speed
+void PlayList_rate_ctypes(void* play_handle, double playing_rate) {
+    if (playing_rate > 0.0)
+        static_cast<PlayHandle*>(play_handle)->play_control.playing_rate.store(playing_rate);
+}
+
+double PlayList_progress_ctypes(void* play_handle) {
+    return static_cast<PlayHandle*>(play_handle)->play_control.played_ms.load();
+}
+
+double PlayList_duration_ctypes(void* play_handle) {
+    return static_cast<PlayHandle*>(play_handle)->play_control.duration_ms.load();
+}
+
+int PlayList_playing_ctypes(void* play_handle) {
+    return !static_cast<PlayHandle*>(play_handle)->play_control.finished_playing.load();
+}
+
+int PlayList_wait_ctypes(void* play_handle) {
+    PlayHandle *handle = static_cast<PlayHandle*>(play_handle);
+    if (handle->play_thread.joinable())
+        handle->play_thread.join();
+    int play_result = handle->play_result;
+    destroyShmRing(handle->shm_name.c_str(), handle->play_control.shm_ring);
+    delete handle;
+    return play_result;
+}
+
 int add_ctypes(int a, int b) {
     return a + b;
 }
\ No newline at end of file
@@ -0,0 +1,280 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#include "JsonMidiPlayer_daemon.hpp"
+#include "JsonMidiPlayer_parser.hpp"
+
+#ifndef _WIN32
+    #include <csignal>
+    #include <cerrno>
+    #include <cstring>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+
+#ifndef _WIN32
+
+// A streaming playing that keeps the devices open between submissions
+struct DaemonSession {
+    PlayControl play_control;
+    std::thread play_thread;
+    size_t submissions = 0;
+};
+
+static volatile std::sig_atomic_t daemon_signal = 0;
+
+static void daemonSignalHandler(int) {
+    daemon_signal = 1;
+}
+
+// Touches the stack pages so that the playing doesn't page fault on them
+static void prefaultStack() {
+    unsigned char stack_bytes[DAEMON_PREFAULT_BYTES];
+    volatile unsigned char *stack_page = stack_bytes;   // Volatile so that the writes aren't optimized away
+    for (size_t byte_i = 0; byte_i < DAEMON_PREFAULT_BYTES; byte_i += 4096)
+        stack_page[byte_i] = 0;
+}
+
+static std::unique_ptr<DaemonSession> startSession(bool verbose, int playing_cpu) {
+    std::unique_ptr<DaemonSession> session(new DaemonSession());
+    DaemonSession *daemon_session = session.get();
+    daemon_session->play_control.streaming_input.store(true);
+    daemon_session->play_control.playing_cpu = playing_cpu;
+    daemon_session->play_thread = std::thread([daemon_session, verbose]() {
+        prefaultStack();
+        try {
+            PlayList("[]", verbose, &daemon_session->play_control);
+        } catch (const std::exception& e) {    // Shall never escape the thread
+            if (verbose) std::cerr << "Error: " << e.what() << std::endl;
+        }
+        daemon_session->play_control.finished_playing.store(true);
+    });
+    return session;
+}
+
+static void stopSession(DaemonSession &session) {
+    session.play_control.stop_playing.store(true);
+    session.play_control.streaming_input.store(false);
+    if (session.play_thread.joinable())
+        session.play_thread.join();
+}
+
+// Points the events_data into the payload, false when it isn't a whole binary events payload
+static bool readEventsPayload(const std::string &payload, MidiEventsData &events_data,
+                                std::vector<const char*> &device_names) {
+    DaemonEventsHeader events_header;
+    if (payload.size() < sizeof(DaemonEventsHeader))
+        return false;
+    std::memcpy(&events_header, payload.data(), sizeof(DaemonEventsHeader));
+    const size_t events_size = static_cast<size_t>(events_header.total_events) * sizeof(MidiEventRecord);
+    if (events_header.magic != DAEMON_EVENTS_MAGIC || payload.size() - sizeof(DaemonEventsHeader) < events_size)
+        return false;
+    const char *events_start = payload.data() + sizeof(DaemonEventsHeader);
+    // The heap buffer of the payload is aligned, and so is its header size
+    if (reinterpret_cast<uintptr_t>(events_start) % alignof(MidiEventRecord) != 0)
+        return false;
+    const char *names_position = events_start + events_size;
+    const char *payload_end = payload.data() + payload.size();
+    device_names.clear();
+    for (uint32_t device_i = 0; device_i < events_header.total_devices; ++device_i) {
+        const void *name_end = std::memchr(names_position, '\0', payload_end - names_position);
+        if (name_end == nullptr)
+            return false;
+        device_names.push_back(names_position);
+        names_position = static_cast<const char*>(name_end) + 1;
+    }
+    if (static_cast<size_t>(payload_end - names_position) != events_header.sysex_size)
+        return false;
+    events_data = { reinterpret_cast<const MidiEventRecord*>(events_start), events_header.total_events,
+                    device_names.data(), device_names.size(),
+                    reinterpret_cast<const unsigned char*>(names_position), events_header.sysex_size };
+    return true;
+}
+
+// Returns the reply line of a single request
+static std::string processRequest(const std::string &request, std::unique_ptr<DaemonSession> &session,
+                                    bool &quitting, bool verbose, int playing_cpu) {
+    size_t line_end = request.find('\n');
+    std::string request_line = request.substr(0, line_end);
+    std::string payload = line_end == std::string::npos ? "" : request.substr(line_end + 1);
+    if (!request_line.empty() && request_line.back() == '\r')
+        request_line.pop_back();
+    size_t command_end = request_line.find(' ');
+    std::string command = request_line.substr(0, command_end);
+    double argument_ms = command_end == std::string::npos ? 0.0 : std::atof(request_line.c_str() + command_end + 1);
+
+    if (command == "PLAY" || command == "QUEUE") {
+        PlayControl &play_control = session->play_control;
+        if (play_control.finished_playing.load())
+            return "ERROR not playing";
+        if (play_control.duration_ms.load() - play_control.timeline_ms.load() > DAEMON_MAXIMUM_AHEAD_MS)
+            return "ERROR queue full";
+        // The payload may also be CBOR or MessagePack, read only once by the daemon instead of by the playing
+        std::vector<JsonFile> json_files;
+        try {
+            json_files = readJsonFiles(reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
+        } catch (const nlohmann::json::exception&) {
+            return "ERROR invalid json";
+        }
+        play_control.appendFragment(std::move(json_files), argument_ms,
+            command == "PLAY" ? fragment_at_now : fragment_at_end);
+        session->submissions++;
+        return "OK";
+    }
+    if (command == "PLAY_EVENTS" || command == "QUEUE_EVENTS") {
+        PlayControl &play_control = session->play_control;
+        if (play_control.finished_playing.load())
+            return "ERROR not playing";
+        if (play_control.duration_ms.load() - play_control.timeline_ms.load() > DAEMON_MAXIMUM_AHEAD_MS)
+            return "ERROR queue full";
+        MidiEventsData events_data;
+        std::vector<const char*> device_names;
+        if (!readEventsPayload(payload, events_data, device_names))
+            return "ERROR invalid events";
+        play_control.appendFragment(events_data, argument_ms,
+            command == "PLAY_EVENTS" ? fragment_at_now : fragment_at_end);
+        session->submissions++;
+        return "OK";
+    }
+    if (command == "STATUS") {
+        PlayControl &play_control = session->play_control;
+        nlohmann::json status = {
+            { "playing", !play_control.finished_playing.load() },
+            { "submissions", session->submissions },
+            { "timeline_ms", play_control.timeline_ms.load() },
+            { "played_ms", play_control.played_ms.load() },
+            { "duration_ms", play_control.duration_ms.load() },
+            { "late_pins", play_control.late_pins.load() },
+            { "first_pin_latency_ms", play_control.first_pin_latency_ms.load() },
+            { "cpu", play_control.playing_cpu },
+            { "pinned", !play_control.pinning_failed.load() }
+        };
+        return status.dump();
+    }
+    if (command == "STOP") {
+        if (session->play_control.finished_playing.load()) {
+            // Only started again if the playing ended on its own, like on an error
+            stopSession(*session);
+            session = startSession(verbose, playing_cpu);
+        } else {
+            session->play_control.flushPlaying();
+        }
+        return "OK";
+    }
+    if (command == "QUIT") {
+        quitting = true;
+        return "OK";
+    }
+    return "ERROR unknown command " + command;
+}
+
+#endif
+
+
+int PlayDaemon(const char* socket_path, bool verbose, int playing_cpu) {
+#ifdef _WIN32
+    std::cerr << "The daemon mode needs Unix domain sockets, not available on Windows" << std::endl;
+    return EXIT_FAILURE;
+#else
+    sockaddr_un address{};
+    if (std::strlen(socket_path) >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socket_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socket_path);
+
+    // Locked memory avoids page faults while playing, being the session memory bounded by the streaming
+    // retention of the played pins and by the size and the queuing limits of the requests
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0 && verbose)
+        std::cerr << "Unable to lock the memory: " << std::strerror(errno) << std::endl;
+
+    int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        std::cerr << "Unable to create the socket: " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    unlink(socket_path);    // Left behind by a previous daemon
+    if (bind(server_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(server_fd, 8) != 0) {
+        std::cerr << "Unable to listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        close(server_fd);
+        return EXIT_FAILURE;
+    }
+
+    // Without SA_RESTART so that a blocked accept returns on these signals
+    struct sigaction signal_action{};
+    signal_action.sa_handler = daemonSignalHandler;
+    sigemptyset(&signal_action.sa_mask);
+    sigaction(SIGINT, &signal_action, nullptr);
+    sigaction(SIGTERM, &signal_action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);  // Clients may leave before being answered
+
+    if (playing_cpu < 0)
+        playing_cpu = getLastCpu();     // Usually the one least busy with the system interrupts
+    std::unique_ptr<DaemonSession> session = startSession(verbose, playing_cpu);
+    if (verbose) std::cout << "Listening on: " << socket_path << std::endl;
+
+    bool quitting = false;
+    while (!quitting && !daemon_signal) {
+        int client_fd = accept(server_fd, nullptr, nullptr);
+        if (client_fd < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "Unable to accept: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        // Each read times out by itself, the whole request is then timed by its deadline
+        timeval receive_timeout{ DAEMON_RECEIVE_TIMEOUT_MS / 1000, DAEMON_RECEIVE_TIMEOUT_MS % 1000 * 1000 };
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout, sizeof(receive_timeout));
+        auto request_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(DAEMON_RECEIVE_TIMEOUT_MS);
+        std::string request;
+        std::string reply;
+        char read_buffer[4096];
+        ssize_t read_bytes;
+        while ((read_bytes = read(client_fd, read_buffer, sizeof(read_buffer))) > 0) {
+            if (request.size() + read_bytes > DAEMON_MAXIMUM_REQUEST_BYTES) {
+                reply = "ERROR request too large";
+                break;
+            }
+            request.append(read_buffer, read_bytes);
+            if (std::chrono::steady_clock::now() > request_deadline) {
+                reply = "ERROR request timeout";
+                break;
+            }
+        }
+        if (reply.empty() && read_bytes < 0)
+            reply = errno == EAGAIN || errno == EWOULDBLOCK ? "ERROR request timeout" : "ERROR " + std::string(std::strerror(errno));
+        if (reply.empty())
+            reply = processRequest(request, session, quitting, verbose, playing_cpu);
+        reply += "\n";
+        for (size_t written = 0; written < reply.size(); ) {
+            ssize_t written_bytes = write(client_fd, reply.data() + written, reply.size() - written);
+            if (written_bytes <= 0)
+                break;
+            written += written_bytes;
+        }
+        close(client_fd);
+    }
+
+    stopSession(*session);
+    close(server_fd);
+    unlink(socket_path);
+    return 0;
+#endif
+}
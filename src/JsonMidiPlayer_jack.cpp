@@ -0,0 +1,167 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#include "JsonMidiPlayer_jack.hpp"
+
+#ifdef JSON_MIDI_PLAYER_JACK
+    #include <jack/jack.h>
+    #include <jack/midiport.h>
+    #include <jack/ringbuffer.h>
+
+
+struct JackEventHeader {
+    jack_nframes_t frame;           // JACK frame time where the message is placed
+    uint32_t message_size;          // Followed by its bytes
+};
+
+struct JackMidiOut::JackOutputData {
+    jack_client_t *jack_client = nullptr;
+    jack_port_t *jack_port = nullptr;
+    jack_ringbuffer_t *ringbuffer = nullptr;
+};
+
+static void silentJackError(const char*) { }
+
+// Runs on the JACK thread, so without any allocation or lock
+static int processJackOutput(jack_nframes_t total_frames, void *jack_output_data) {
+    JackMidiOut::JackOutputData *jack_data = static_cast<JackMidiOut::JackOutputData*>(jack_output_data);
+    void *port_buffer = jack_port_get_buffer(jack_data->jack_port, total_frames);
+    jack_midi_clear_buffer(port_buffer);
+    const jack_nframes_t cycle_start = jack_last_frame_time(jack_data->jack_client);
+    jack_nframes_t last_offset = 0;
+    JackEventHeader event_header;
+    while (jack_ringbuffer_read_space(jack_data->ringbuffer) >= sizeof(JackEventHeader)) {
+        jack_ringbuffer_peek(jack_data->ringbuffer, reinterpret_cast<char*>(&event_header), sizeof(JackEventHeader));
+        // Frame times wrap around, so they are compared by their difference
+        const int32_t frame_offset = static_cast<int32_t>(event_header.frame - cycle_start);
+        if (frame_offset >= static_cast<int32_t>(total_frames))
+            break;  // For a next period
+        // The late ones as soon as possible, keeping the events in order
+        const jack_nframes_t event_offset = std::max(last_offset, static_cast<jack_nframes_t>(std::max(frame_offset, 0)));
+        jack_ringbuffer_read_advance(jack_data->ringbuffer, sizeof(JackEventHeader));
+        jack_midi_data_t *event_data = jack_midi_event_reserve(port_buffer, event_offset, event_header.message_size);
+        if (event_data != nullptr)
+            jack_ringbuffer_read(jack_data->ringbuffer, reinterpret_cast<char*>(event_data), event_header.message_size);
+        else
+            jack_ringbuffer_read_advance(jack_data->ringbuffer, event_header.message_size);   // The period is full
+        last_offset = event_offset;
+    }
+    return 0;
+}
+
+#endif
+
+
+std::vector<JackMidiPort> getJackMidiPorts() {
+    std::vector<JackMidiPort> jack_ports;
+#ifdef JSON_MIDI_PLAYER_JACK
+    jack_set_error_function(silentJackError);   // No server running is the usual case
+    jack_client_t *jack_client = jack_client_open("JsonMidiPlayer", JackNoStartServer, nullptr);
+    if (jack_client == nullptr)
+        return jack_ports;
+    const char **port_names = jack_get_ports(jack_client, nullptr, JACK_DEFAULT_MIDI_TYPE, JackPortIsInput);
+    if (port_names != nullptr) {
+        for (size_t port_i = 0; port_names[port_i] != nullptr; ++port_i)
+            jack_ports.push_back({ JACK_PREFIX + std::string(port_names[port_i]), port_names[port_i] });
+        jack_free(port_names);
+    }
+    jack_client_close(jack_client);
+#endif
+    return jack_ports;
+}
+
+
+JackMidiOut::JackMidiOut(const std::string &port_name)
+    : port_name(port_name) { }
+
+JackMidiOut::~JackMidiOut() {
+    closePort();
+}
+
+const char *JackMidiOut::getNamePrefix() const {
+    return JACK_PREFIX;
+}
+
+void JackMidiOut::openPort() {
+#ifdef JSON_MIDI_PLAYER_JACK
+    if (jack_data != nullptr)
+        return;
+    JackOutputData *opening_data = new JackOutputData();
+    opening_data->jack_client = jack_client_open("JsonMidiPlayer", JackNoStartServer, nullptr);
+    if (opening_data->jack_client == nullptr) {
+        delete opening_data;
+        throw RtMidiError("JackMidiOut::openPort: no JACK server running", RtMidiError::DRIVER_ERROR);
+    }
+    opening_data->ringbuffer = jack_ringbuffer_create(JACK_RINGBUFFER_BYTES);
+    if (opening_data->ringbuffer == nullptr) {
+        jack_client_close(opening_data->jack_client);
+        delete opening_data;
+        throw RtMidiError("JackMidiOut::openPort: unable to allocate the ringbuffer", RtMidiError::MEMORY_ERROR);
+    }
+    jack_ringbuffer_mlock(opening_data->ringbuffer);    // Read by the JACK thread, so never paged out
+    opening_data->jack_port = jack_port_register(opening_data->jack_client, "midi_out",
+                                                    JACK_DEFAULT_MIDI_TYPE, JackPortIsOutput, 0);
+    if (opening_data->jack_port == nullptr
+            || jack_set_process_callback(opening_data->jack_client, processJackOutput, opening_data) != 0
+            || jack_activate(opening_data->jack_client) != 0
+            || jack_connect(opening_data->jack_client, jack_port_name(opening_data->jack_port), port_name.c_str()) != 0) {
+        jack_client_close(opening_data->jack_client);
+        jack_ringbuffer_free(opening_data->ringbuffer);
+        delete opening_data;
+        throw RtMidiError("JackMidiOut::openPort: error connecting to " + port_name, RtMidiError::DRIVER_ERROR);
+    }
+    jack_data = opening_data;
+#else
+    throw RtMidiError("JackMidiOut::openPort: built without the JACK output", RtMidiError::INVALID_DEVICE);
+#endif
+}
+
+void JackMidiOut::closePort() {
+#ifdef JSON_MIDI_PLAYER_JACK
+    if (jack_data != nullptr) {
+        for (int wait_i = 0; wait_i < 1000 && jack_ringbuffer_read_space(jack_data->ringbuffer) > 0; ++wait_i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        jack_deactivate(jack_data->jack_client);
+        jack_client_close(jack_data->jack_client);
+        jack_ringbuffer_free(jack_data->ringbuffer);
+        delete jack_data;
+        jack_data = nullptr;
+    }
+#endif
+}
+
+// Without JACK the messages are only dropped, like when its client couldn't be opened
+void JackMidiOut::sendMessage([[maybe_unused]] const unsigned char *midi_message, [[maybe_unused]] size_t message_size,
+                                [[maybe_unused]] double late_ms) {
+#ifdef JSON_MIDI_PLAYER_JACK
+    if (jack_data == nullptr || message_size == 0)
+        return;
+    // Placed one period after its time, given that the current period is already being played,
+    // so that how late it's sent doesn't change where it's placed
+    const jack_time_t message_time_us = jack_get_time() - static_cast<jack_time_t>(std::llround(late_ms * 1000.0));
+    JackEventHeader event_header = {
+        jack_time_to_frames(jack_data->jack_client, message_time_us) + jack_get_buffer_size(jack_data->jack_client),
+        static_cast<uint32_t>(message_size)
+    };
+    const size_t event_size = sizeof(JackEventHeader) + message_size;
+    if (jack_ringbuffer_write_space(jack_data->ringbuffer) < event_size)
+        return;     // Dropped, the JACK thread isn't taking them
+    // Written at once, so that the JACK thread never reads a header without its bytes
+    event_buffer.resize(event_size);
+    std::memcpy(event_buffer.data(), &event_header, sizeof(JackEventHeader));
+    std::memcpy(event_buffer.data() + sizeof(JackEventHeader), midi_message, message_size);
+    jack_ringbuffer_write(jack_data->ringbuffer, event_buffer.data(), event_size);
+#endif
+}
@@ -0,0 +1,870 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#include "JsonMidiPlayer_parser.hpp"
+
+#define JSON_MAXIMUM_DEPTH 64   // Deeper values of unknown keys are left to nlohmann
+
+
+// Exactly represented by a double, so a mantissa up to 2^53 times or divided by one of them is correctly rounded
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+struct JsonNumber {
+    double value = 0.0;
+    bool integer = false;   // Without fraction nor exponent
+};
+
+// Like the nlohmann conversion of a number to an unsigned char, but without wrapping around
+static bool isByteNumber(const JsonNumber &number) {
+    return number.value >= 0.0 && number.value < 256.0;
+}
+
+// Like the nlohmann unsigned integers of the rows, being data bytes below 0x80
+static bool isUnsignedNumber(const JsonNumber &number, double limit) {
+    return number.integer && number.value >= 0.0 && number.value < limit;
+}
+
+static void appendUtf8(std::string &string_value, uint32_t code_point) {
+    if (code_point < 0x80) {
+        string_value.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        string_value.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        string_value.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        string_value.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        string_value.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        string_value.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        string_value.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        string_value.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        string_value.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        string_value.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+
+// Single pass over the json text of the Json Midi Player schema, writing each item straight into the events
+// of its file, while anything it doesn't expect makes it fail so that the whole document is left to nlohmann
+class JsonSchemaParser {
+
+    private:
+        const unsigned char *json_data;
+        const size_t json_size;
+        MidiDeviceResolver *device_resolver;    // Given the device names as soon as they are read
+        size_t position = 0;
+        // Reused between items, so that no allocations are needed once they are big enough
+        std::string key;
+        std::string string_value;
+        std::vector<std::string> device_names;
+        std::vector<unsigned char> midi_message;
+
+        bool fail(const char *reason) {
+            if (failure == nullptr) {
+                failure = reason;
+                failure_offset = position;
+            }
+            return false;
+        }
+
+        void skipSpaces() {
+            while (position < json_size && (json_data[position] == ' ' || json_data[position] == '\n'
+                    || json_data[position] == '\r' || json_data[position] == '\t'))
+                ++position;
+        }
+
+        bool nextIs(unsigned char character) {
+            skipSpaces();
+            return position < json_size && json_data[position] == character;
+        }
+
+        bool skipIf(unsigned char character) {
+            if (!nextIs(character))
+                return false;
+            ++position;
+            return true;
+        }
+
+        bool expect(unsigned char character) {
+            return skipIf(character) || fail("unexpected character");
+        }
+
+        bool nextIsNumber() {
+            skipSpaces();
+            return position < json_size && (json_data[position] == '-' || (json_data[position] >= '0' && json_data[position] <= '9'));
+        }
+
+        bool nextIsDigit() const {
+            return position < json_size && json_data[position] >= '0' && json_data[position] <= '9';
+        }
+
+        // Calls readMember with each key of the object already read into key
+        template <typename ReadMember>
+        bool readObject(ReadMember readMember) {
+            if (!expect('{'))
+                return false;
+            if (skipIf('}'))
+                return true;
+            do {
+                if (!readString(key) || !expect(':') || !readMember())
+                    return false;
+            } while (skipIf(','));
+            return expect('}');
+        }
+
+        template <typename ReadElement>
+        bool readArray(ReadElement readElement) {
+            if (!expect('['))
+                return false;
+            if (skipIf(']'))
+                return true;
+            do {
+                if (!readElement())
+                    return false;
+            } while (skipIf(','));
+            return expect(']');
+        }
+
+        bool readHexadecimal(uint32_t &code_unit) {
+            if (position + 4 > json_size)
+                return fail("unterminated escape");
+            code_unit = 0;
+            for (size_t digit_i = 0; digit_i < 4; ++digit_i) {
+                unsigned char digit = json_data[position++];
+                code_unit <<= 4;
+                if (digit >= '0' && digit <= '9')
+                    code_unit |= digit - '0';
+                else if (digit >= 'a' && digit <= 'f')
+                    code_unit |= digit - 'a' + 10;
+                else if (digit >= 'A' && digit <= 'F')
+                    code_unit |= digit - 'A' + 10;
+                else
+                    return fail("invalid escape");
+            }
+            return true;
+        }
+
+        bool readString(std::string &string_read) {
+            if (!expect('"'))
+                return false;
+            const size_t string_start = position;
+            // Most strings have no escapes and are copied at once
+            while (position < json_size && json_data[position] != '"' && json_data[position] != '\\') {
+                if (json_data[position] < 0x20)
+                    return fail("control character in a string");
+                ++position;
+            }
+            string_read.assign(reinterpret_cast<const char*>(json_data + string_start), position - string_start);
+            while (position < json_size) {
+                unsigned char character = json_data[position++];
+                if (character == '"')
+                    return true;
+                if (character < 0x20)
+                    return fail("control character in a string");
+                if (character != '\\') {
+                    string_read.push_back(static_cast<char>(character));
+                    continue;
+                }
+                if (position == json_size)
+                    break;
+                switch (json_data[position++]) {
+                    case '"':   string_read.push_back('"');     break;
+                    case '\\':  string_read.push_back('\\');    break;
+                    case '/':   string_read.push_back('/');     break;
+                    case 'b':   string_read.push_back('\b');    break;
+                    case 'f':   string_read.push_back('\f');    break;
+                    case 'n':   string_read.push_back('\n');    break;
+                    case 'r':   string_read.push_back('\r');    break;
+                    case 't':   string_read.push_back('\t');    break;
+                    case 'u':
+                    {
+                        uint32_t code_point;
+                        if (!readHexadecimal(code_point))
+                            return false;
+                        if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                            uint32_t low_surrogate;
+                            if (position + 2 > json_size || json_data[position] != '\\' || json_data[position + 1] != 'u')
+                                return fail("unpaired surrogate");
+                            position += 2;
+                            if (!readHexadecimal(low_surrogate))
+                                return false;
+                            if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+                                return fail("unpaired surrogate");
+                            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                        } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+                            return fail("unpaired surrogate");
+                        }
+                        appendUtf8(string_read, code_point);
+                        break;
+                    }
+                    default:
+                        return fail("invalid escape");
+                }
+            }
+            return fail("unterminated string");
+        }
+
+        // Up to 19 significant digits are kept in an integer mantissa, being the result exact while both
+        // the mantissa and its power of ten are exact doubles, the rare other ones are left to strtod
+        bool readNumber(JsonNumber &number) {
+            skipSpaces();
+            const size_t number_start = position;
+            bool negative = false;
+            if (position < json_size && json_data[position] == '-') {
+                negative = true;
+                ++position;
+            }
+            if (!nextIsDigit())
+                return fail("number expected");
+            uint64_t mantissa = 0;
+            int significant_digits = 0;
+            int exponent = 0;
+            bool exact = true;
+            bool integer = true;
+            if (json_data[position] == '0') {
+                ++position;
+            } else {
+                for (; nextIsDigit(); ++position) {
+                    if (significant_digits < 19) {
+                        mantissa = mantissa * 10 + (json_data[position] - '0');
+                        significant_digits++;
+                    } else {
+                        exponent++;
+                        exact = false;
+                    }
+                }
+            }
+            if (position < json_size && json_data[position] == '.') {
+                integer = false;
+                ++position;
+                if (!nextIsDigit())
+                    return fail("digit expected");
+                for (; nextIsDigit(); ++position) {
+                    if (significant_digits < 19) {
+                        mantissa = mantissa * 10 + (json_data[position] - '0');
+                        significant_digits++;
+                        exponent--;
+                    } else {
+                        exact = false;
+                    }
+                }
+            }
+            if (position < json_size && (json_data[position] == 'e' || json_data[position] == 'E')) {
+                integer = false;
+                ++position;
+                bool negative_exponent = false;
+                if (position < json_size && (json_data[position] == '-' || json_data[position] == '+'))
+                    negative_exponent = json_data[position++] == '-';
+                if (!nextIsDigit())
+                    return fail("digit expected");
+                int exponent_value = 0;
+                for (; nextIsDigit(); ++position) {
+                    if (exponent_value < 10000)
+                        exponent_value = exponent_value * 10 + (json_data[position] - '0');
+                }
+                exponent += negative_exponent ? -exponent_value : exponent_value;
+            }
+            if (exact && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+                double value = static_cast<double>(mantissa);
+                value = exponent < 0 ? value / exact_powers_of_ten[-exponent] : value * exact_powers_of_ten[exponent];
+                number.value = negative ? -value : value;
+            } else {
+                char number_text[64];
+                const size_t number_length = position - number_start;
+                if (number_length >= sizeof(number_text))
+                    return fail("number too long");
+                std::memcpy(number_text, json_data + number_start, number_length);
+                number_text[number_length] = '\0';
+                number.value = std::strtod(number_text, nullptr);
+            }
+            number.integer = integer && exact;
+            return true;
+        }
+
+        bool readLiteral(const char *literal) {
+            const size_t literal_size = std::strlen(literal);
+            if (position + literal_size > json_size || std::memcmp(json_data + position, literal, literal_size) != 0)
+                return fail("unexpected character");
+            position += literal_size;
+            return true;
+        }
+
+        bool skipValue(size_t depth = 0) {
+            skipSpaces();
+            if (position == json_size)
+                return fail("value expected");
+            if (depth == JSON_MAXIMUM_DEPTH)
+                return fail("too deeply nested");
+            switch (json_data[position]) {
+                case '"':
+                    return readString(string_value);
+                case '{':
+                    return readObject([&]() { return skipValue(depth + 1); });
+                case '[':
+                    return readArray([&]() { return skipValue(depth + 1); });
+                case 't':
+                    return readLiteral("true");
+                case 'f':
+                    return readLiteral("false");
+                case 'n':
+                    return readLiteral("null");
+                default:
+                {
+                    JsonNumber number;
+                    return readNumber(number);
+                }
+            }
+        }
+
+        // A value of another type is skipped, leaving is_number false
+        bool readNumberValue(JsonNumber &number, bool &is_number) {
+            is_number = nextIsNumber();
+            return is_number ? readNumber(number) : skipValue();
+        }
+
+        // A single name or a list of them, being valid false when any of them isn't a string
+        bool readDeviceNames(bool &valid) {
+            device_names.clear();
+            valid = true;
+            if (nextIs('"')) {
+                device_names.emplace_back();
+                return readString(device_names.back());
+            }
+            if (!nextIs('[')) {
+                valid = false;
+                return skipValue();
+            }
+            return readArray([&]() {
+                if (!nextIs('"')) {
+                    valid = false;
+                    return skipValue();
+                }
+                device_names.emplace_back();
+                return readString(device_names.back());
+            });
+        }
+
+        uint32_t internDevicesList(std::vector<std::vector<std::string>> &devices_lists) {
+            for (size_t list_i = 0; list_i < devices_lists.size(); ++list_i) {
+                if (devices_lists[list_i] == device_names)
+                    return static_cast<uint32_t>(list_i);
+            }
+            devices_lists.push_back(device_names);
+            if (device_resolver != nullptr)
+                device_resolver->requestNames(device_names);
+            return static_cast<uint32_t>(devices_lists.size() - 1);
+        }
+
+        // The midi_message being valid and with a priority, the ones longer than 3 bytes kept in the SysEx data
+        bool addEvent(JsonFile &json_file, std::vector<JsonEventRecord> &events, double time_ms, uint32_t devices_index) {
+            if (!isValidMidiMessage(midi_message.data(), midi_message.size()))
+                return false;
+            unsigned char priority = getMessagePriority(midi_message.data(), midi_message.size());
+            if (priority == 0x00)
+                return false;
+            JsonEventRecord json_event;
+            json_event.time_ms = time_ms;
+            json_event.devices_index = devices_index;
+            json_event.message_size = static_cast<uint32_t>(midi_message.size());
+            json_event.sysex_offset = 0;
+            json_event.priority = priority;
+            if (midi_message.size() <= sizeof(json_event.midi_message)) {
+                std::memcpy(json_event.midi_message, midi_message.data(), midi_message.size());
+            } else {
+                json_event.sysex_offset = static_cast<uint32_t>(json_file.sysex_data.size());
+                json_file.sysex_data.insert(json_file.sysex_data.end(), midi_message.begin(), midi_message.end());
+            }
+            events.push_back(json_event);
+            return true;
+        }
+
+        void rejectItem(JsonFile &json_file, size_t byte_offset, uint32_t devices_index, const char *reason) {
+            json_file.rejected_items.push_back({ byte_offset, devices_index, reason });
+        }
+
+        // [time_ms, status_byte, data_byte_1, data_byte_2] or [time_ms, 240, [data_bytes]], like processJsonRows
+        bool readRow(JsonFile &json_file) {
+            skipSpaces();
+            const size_t row_offset = position;
+            if (!nextIs('[')) {
+                rejectItem(json_file, row_offset, rejected_rows_item, "row isn't a list");
+                return skipValue();
+            }
+            size_t element_i = 0;
+            bool valid = true;
+            bool sysex_list = false;
+            double time_ms = 0.0;
+            midi_message.clear();
+            bool read = readArray([&]() {
+                JsonNumber number;
+                bool is_number;
+                switch (element_i++) {
+                    case 0:
+                        if (!readNumberValue(number, is_number))
+                            return false;
+                        valid = valid && is_number;
+                        time_ms = number.value;
+                        return true;
+                    case 1:
+                        if (!readNumberValue(number, is_number))
+                            return false;
+                        valid = valid && is_number && isUnsignedNumber(number, 256.0);
+                        midi_message.push_back(static_cast<unsigned char>(number.value));
+                        return true;
+                    default:
+                        if (nextIs('[')) {
+                            if (!valid || element_i != 3 || midi_message[0] != system_sysex_start) {
+                                valid = false;
+                                return skipValue();
+                            }
+                            sysex_list = true;
+                            return readArray([&]() {
+                                JsonNumber data_byte;
+                                bool is_byte;
+                                if (!readNumberValue(data_byte, is_byte))
+                                    return false;
+                                valid = valid && is_byte && isUnsignedNumber(data_byte, 128.0);
+                                midi_message.push_back(static_cast<unsigned char>(data_byte.value));
+                                return true;
+                            });
+                        }
+                        if (!readNumberValue(number, is_number))
+                            return false;
+                        valid = valid && is_number && isUnsignedNumber(number, 128.0);
+                        midi_message.push_back(static_cast<unsigned char>(number.value));
+                        return true;
+                }
+            });
+            if (!read)
+                return false;
+            if (element_i < 2 || !valid || time_ms < 0) {
+                rejectItem(json_file, row_offset, rejected_rows_item, "row without a valid time and status byte");
+                return true;
+            }
+            if (midi_message[0] == system_sysex_start) {
+                if ((element_i == 3 && !sysex_list) || (sysex_list && element_i != 3)) {
+                    rejectItem(json_file, row_offset, rejected_rows_item, "SysEx row without its data bytes list");
+                    return true;
+                }
+                midi_message.push_back(system_sysex_end);
+            }
+            // The device of the rows is only set once the whole item is read
+            if (!addEvent(json_file, json_file.rows_events, time_ms, rejected_rows_item))
+                rejectItem(json_file, row_offset, rejected_rows_item, "row isn't a valid midi message");
+            return true;
+        }
+
+        // Only valid with all its keys, like in processJsonData
+        bool readClock(JsonClock &json_clock, bool &valid) {
+            valid = false;
+            if (!nextIs('{'))
+                return skipValue();
+            bool has_pulses = false, has_numerator = false, has_denominator = false;
+            bool has_clocked = false, has_controlled = false;
+            bool valid_values = true;
+            bool read = readObject([&]() {
+                JsonNumber number;
+                bool is_number;
+                bool valid_names;
+                if (key == "total_clock_pulses" || key == "pulse_duration_min_numerator" || key == "pulse_duration_min_denominator") {
+                    if (!readNumberValue(number, is_number))
+                        return false;
+                    valid_values = valid_values && is_number && number.value >= 0.0 && number.value <= std::numeric_limits<unsigned int>::max();
+                    const unsigned int clock_value = valid_values ? static_cast<unsigned int>(number.value) : 0;
+                    if (key == "total_clock_pulses") {
+                        json_clock.total_clock_pulses = clock_value;
+                        has_pulses = true;
+                    } else if (key == "pulse_duration_min_numerator") {
+                        json_clock.pulse_duration_min_numerator = clock_value;
+                        has_numerator = true;
+                    } else {
+                        json_clock.pulse_duration_min_denominator = clock_value;
+                        has_denominator = true;
+                    }
+                    return true;
+                }
+                if (key == "clocked_devices" || key == "controlled_devices") {
+                    if (!readDeviceNames(valid_names))
+                        return false;
+                    valid_values = valid_values && valid_names;
+                    if (key == "clocked_devices") {
+                        json_clock.clocked_devices = device_names;
+                        has_clocked = true;
+                    } else {
+                        json_clock.controlled_devices = device_names;
+                        has_controlled = true;
+                    }
+                    return true;
+                }
+                return skipValue();
+            });
+            valid = valid_values && has_pulses && has_numerator && has_denominator && has_clocked && has_controlled;
+            return read;
+        }
+
+        // Where an item is set like processJsonData does, by the first of its keys found: "rows", "midi_message",
+        // "devices" and "clock", being the last "devices" list read the one of the next midi messages
+        bool readItem(JsonFile &json_file, uint32_t &devices_index) {
+            skipSpaces();
+            const size_t item_offset = position;
+            if (!nextIs('{'))
+                return skipValue();     // Without any of the keys, like any other item
+
+            bool has_rows = false, has_midi_message = false, has_devices = false, has_clock = false, valid_clock = false;
+            JsonClock json_clock;
+            const size_t rows_start = json_file.rows_events.size();
+            uint32_t rows_device = rejected_rows_item;
+            bool has_time = false, valid_time = false;
+            JsonNumber time_ms;
+            // The midi_message keys
+            bool valid_message = false;
+            bool has_status = false, has_data_1 = false, has_data_2 = false, has_data = false, has_data_bytes = false;
+            JsonNumber status_byte, data_byte_1, data_byte_2, data_byte;
+            bool valid_status = false, valid_data_1 = false, valid_data_2 = false, valid_data = false, valid_data_bytes = false;
+            std::vector<unsigned char> sysex_data_bytes;
+            uint32_t item_devices_index = devices_index;
+
+            bool read = readObject([&]() {
+                if (key == "midi_message") {
+                    has_midi_message = true;
+                    if (!nextIs('{'))
+                        return skipValue();
+                    valid_message = true;
+                    return readObject([&]() {
+                        if (key == "status_byte") {
+                            has_status = true;
+                            return readNumberValue(status_byte, valid_status);
+                        } else if (key == "data_byte_1") {
+                            has_data_1 = true;
+                            return readNumberValue(data_byte_1, valid_data_1);
+                        } else if (key == "data_byte_2") {
+                            has_data_2 = true;
+                            return readNumberValue(data_byte_2, valid_data_2);
+                        } else if (key == "data_byte") {
+                            has_data = true;
+                            return readNumberValue(data_byte, valid_data);
+                        } else if (key == "data_bytes") {
+                            has_data_bytes = true;
+                            sysex_data_bytes.clear();
+                            if (!nextIs('['))
+                                return skipValue();
+                            valid_data_bytes = true;
+                            return readArray([&]() {
+                                JsonNumber sysex_byte;
+                                bool is_number;
+                                if (!readNumberValue(sysex_byte, is_number))
+                                    return false;
+                                valid_data_bytes = valid_data_bytes && is_number && isByteNumber(sysex_byte);
+                                sysex_data_bytes.push_back(static_cast<unsigned char>(sysex_byte.value));
+                                return true;
+                            });
+                        }
+                        return skipValue();
+                    });
+                } else if (key == "time_ms") {
+                    has_time = true;
+                    return readNumberValue(time_ms, valid_time);
+                } else if (key == "devices") {
+                    bool valid_names;
+                    if (!readDeviceNames(valid_names))
+                        return false;
+                    if (!valid_names)
+                        return fail("device names aren't strings");
+                    has_devices = true;
+                    item_devices_index = internDevicesList(json_file.devices_lists);
+                    return true;
+                } else if (key == "clock") {
+                    has_clock = true;
+                    return readClock(json_clock, valid_clock);
+                } else if (key == "rows") {
+                    has_rows = true;
+                    if (!nextIs('['))
+                        return skipValue();
+                    return readArray([&]() { return readRow(json_file); });
+                } else if (key == "device") {
+                    JsonNumber device_index;
+                    bool is_number;
+                    if (!readNumberValue(device_index, is_number))
+                        return false;
+                    if (is_number && isUnsignedNumber(device_index, rejected_never_counted))
+                        rows_device = static_cast<uint32_t>(device_index.value);
+                    return true;
+                }
+                return skipValue();
+            });
+            if (!read)
+                return false;
+
+            if (has_rows) {
+                for (size_t event_i = rows_start; event_i < json_file.rows_events.size(); ++event_i)
+                    json_file.rows_events[event_i].devices_index = rows_device;
+                return true;
+            }
+            if (has_midi_message) {
+                if (devices_index == rejected_never_counted) {
+                    rejectItem(json_file, item_offset, rejected_never_counted, "midi_message before any devices");
+                    return true;
+                }
+                if (!has_time || !valid_time) {
+                    rejectItem(json_file, item_offset, devices_index, "time_ms isn't a number");
+                    return true;
+                }
+                if (time_ms.value < 0) {
+                    rejectItem(json_file, item_offset, devices_index, "negative time_ms");
+                    return true;
+                }
+                if (!valid_message || !has_status || !valid_status || !isByteNumber(status_byte)) {
+                    rejectItem(json_file, item_offset, devices_index, "status_byte isn't a byte");
+                    return true;
+                }
+                midi_message.assign(1, static_cast<unsigned char>(status_byte.value));
+                switch (midi_message[0] & 0xF0) {
+                    case action_system:
+                        if (midi_message[0] == system_song_pointer) {
+                            if (!has_data_1 || !has_data_2 || !valid_data_1 || !valid_data_2
+                                    || !isByteNumber(data_byte_1) || !isByteNumber(data_byte_2)) {
+                                rejectItem(json_file, item_offset, devices_index, "data bytes aren't bytes");
+                                return true;
+                            }
+                            midi_message.push_back(static_cast<unsigned char>(data_byte_1.value));
+                            midi_message.push_back(static_cast<unsigned char>(data_byte_2.value));
+                        } else if (midi_message[0] == system_sysex_start) {
+                            if (!has_data_bytes || !valid_data_bytes) {
+                                rejectItem(json_file, item_offset, devices_index, "data_bytes isn't a list of bytes");
+                                return true;
+                            }
+                            for (unsigned char sysex_data_byte : sysex_data_bytes) {
+                                // Makes sure it's SysEx valid data
+                                if (sysex_data_byte != system_sysex_start && sysex_data_byte != system_sysex_end)
+                                    midi_message.push_back(sysex_data_byte);
+                            }
+                            midi_message.push_back(system_sysex_end);
+                        }
+                        break;
+                    case action_note_off:
+                    case action_note_on:
+                    case action_control_change:
+                    case action_pitch_bend:
+                    case action_key_pressure:
+                        if (!has_data_1 || !has_data_2 || !valid_data_1 || !valid_data_2
+                                || !isByteNumber(data_byte_1) || !isByteNumber(data_byte_2)) {
+                            rejectItem(json_file, item_offset, devices_index, "data bytes aren't bytes");
+                            return true;
+                        }
+                        midi_message.push_back(static_cast<unsigned char>(data_byte_1.value));
+                        midi_message.push_back(static_cast<unsigned char>(data_byte_2.value));
+                        break;
+                    case action_program_change:
+                    case action_channel_pressure:
+                        if (!has_data || !valid_data || !isByteNumber(data_byte)) {
+                            rejectItem(json_file, item_offset, devices_index, "data_byte isn't a byte");
+                            return true;
+                        }
+                        midi_message.push_back(static_cast<unsigned char>(data_byte.value));
+                        break;
+                }
+                if (!addEvent(json_file, json_file.events, time_ms.value, devices_index))
+                    rejectItem(json_file, item_offset, devices_index, "not a valid midi message");
+                return true;
+            }
+            if (has_devices) {
+                devices_index = item_devices_index;
+            } else if (has_clock) {
+                if (valid_clock) {
+                    if (device_resolver != nullptr) {
+                        device_resolver->requestNames(json_clock.clocked_devices, true);
+                        device_resolver->requestNames(json_clock.controlled_devices, true);
+                    }
+                    json_file.clocks.push_back(std::move(json_clock));
+                } else {
+                    rejectItem(json_file, item_offset, rejected_never_counted, "clock without its pulses or devices");
+                }
+            }
+            return true;
+        }
+
+        bool readContent(JsonFile &json_file) {
+            if (!nextIs('[')) {
+                json_file.has_content = false;
+                return skipValue();
+            }
+            uint32_t devices_index = rejected_never_counted;    // None before the first "devices" item
+            size_t total_items = 0;
+            bool read = readArray([&]() {
+                total_items++;
+                return readItem(json_file, devices_index);
+            });
+            json_file.has_content = total_items > 0;
+            return read;
+        }
+
+        bool readFile(JsonFile &json_file) {
+            bool file_type = false, file_url = false;
+            bool read = readObject([&]() {
+                if (key == "filetype" || key == "url") {
+                    bool matches = false;
+                    if (nextIs('"')) {
+                        if (!readString(string_value))
+                            return false;
+                        matches = string_value == (key == "filetype" ? FILE_TYPE : FILE_URL);
+                    } else if (!skipValue()) {
+                        return false;
+                    }
+                    (key == "filetype" ? file_type : file_url) = matches;
+                    return true;
+                } else if (key == "content") {
+                    return readContent(json_file);
+                } else if (key == "encoding") {
+                    if (!nextIs('"'))
+                        return fail("encoding isn't a string");
+                    json_file.has_encoding = true;
+                    return readString(json_file.encoding);
+                } else if (key == "devices") {
+                    json_file.rows_devices_lists.clear();
+                    return readArray([&]() {
+                        bool valid_names;
+                        if (!readDeviceNames(valid_names))
+                            return false;
+                        if (!valid_names)
+                            return fail("device names aren't strings");
+                        json_file.rows_devices_lists.push_back(device_names);
+                        if (device_resolver != nullptr)
+                            device_resolver->requestNames(device_names);
+                        return true;
+                    });
+                }
+                return skipValue();
+            });
+            json_file.file_type = file_type && file_url;
+            return read;
+        }
+
+    public:
+        const char *failure = nullptr;
+        size_t failure_offset = 0;
+
+        JsonSchemaParser(const unsigned char* json_data, size_t json_size, MidiDeviceResolver *device_resolver)
+            : json_data(json_data), json_size(json_size), device_resolver(device_resolver) { }
+
+        // A list of files or a single one, like the ones given to PlayData
+        bool readFiles(std::vector<JsonFile> &json_files) {
+            if (nextIs('{')) {
+                json_files.emplace_back();
+                if (!readFile(json_files.back()))
+                    return false;
+            } else {
+                bool read = readArray([&]() {
+                    if (!nextIs('{'))
+                        return fail("file isn't an object");
+                    json_files.emplace_back();
+                    return readFile(json_files.back());
+                });
+                if (!read)
+                    return false;
+            }
+            skipSpaces();
+            return position == json_size || fail("unexpected data after the files");
+        }
+};
+
+
+std::vector<JsonFile> readJsonFiles(const unsigned char* input_data, size_t input_size,
+                                        unsigned char input_format, bool verbose, MidiDeviceResolver *device_resolver) {
+    std::vector<JsonFile> json_files;
+    if (input_format == format_detect)
+        input_format = getInputFormat(input_data, input_size);
+    if (input_format == format_json) {
+        JsonSchemaParser schema_parser(input_data, input_size, device_resolver);
+        if (schema_parser.readFiles(json_files))
+            return json_files;
+        if (verbose) std::cerr << "Unusual json, read by nlohmann instead: " << schema_parser.failure
+                                << " at byte " << schema_parser.failure_offset << std::endl;
+        json_files.clear();
+    }
+    nlohmann::json json_files_data = parseInputData(input_data, input_size, input_format);
+    if (json_files_data.is_array()) {
+        json_files.resize(json_files_data.size());
+        for (size_t file_i = 0; file_i < json_files_data.size(); ++file_i)
+            json_files[file_i].json_data = std::move(json_files_data[file_i]);
+    } else {
+        json_files.resize(1);   // A single file
+        json_files[0].json_data = std::move(json_files_data);
+    }
+    return json_files;
+}
+
+
+void processJsonFile(JsonFile &json_file, MidiDeviceResolver &device_resolver,
+                        std::list<MidiPin> &midiToProcess, PlayReporting &play_reporting, bool verbose, double offset_ms) {
+
+    if (!json_file.json_data.is_null()) {
+        processJsonData(json_file.json_data, device_resolver, midiToProcess, play_reporting, verbose, offset_ms);
+        return;
+    }
+    if (!json_file.file_type) {
+        if (verbose) std::cerr << "Wrong type of file!" << std::endl;
+        return;
+    }
+    const bool rows_encoding = json_file.has_encoding && json_file.encoding == "rows";
+    if (json_file.has_encoding && !rows_encoding) {
+        if (verbose) std::cerr << "Unknown encoding: \"" << json_file.encoding << "\"" << std::endl;
+        return;
+    }
+    std::vector<MidiDevice*> rows_devices;
+    if (rows_encoding) {
+        for (const std::vector<std::string> &device_names : json_file.rows_devices_lists)
+            rows_devices.push_back(device_resolver.getDevice(device_resolver.connectNames(device_names)));
+    }
+    if (!json_file.has_content) {
+        if (verbose) std::cout << "JSON file is empty." << std::endl;
+        return;
+    }
+
+    for (const JsonClock &json_clock : json_file.clocks)
+        addClockPins(json_clock, device_resolver, midiToProcess, play_reporting, offset_ms);
+    // Each distinct "devices" list is connected only once
+    std::vector<MidiDevice*> midi_devices;
+    for (const std::vector<std::string> &device_names : json_file.devices_lists)
+        midi_devices.push_back(device_resolver.getDevice(device_resolver.connectNames(device_names)));
+
+    auto addPins = [&](const std::vector<JsonEventRecord> &events, const std::vector<MidiDevice*> &events_devices, bool rows) {
+        for (const JsonEventRecord &json_event : events) {
+            MidiDevice *midi_device = json_event.devices_index < events_devices.size() ? events_devices[json_event.devices_index] : nullptr;
+            if (midi_device == nullptr) {
+                if (rows) play_reporting.total_incorrect++;   // Like processJsonRows
+                continue;
+            }
+            const unsigned char *midi_message = json_event.message_size <= sizeof(json_event.midi_message)
+                ? json_event.midi_message : json_file.sysex_data.data() + json_event.sysex_offset;
+            midiToProcess.push_back( MidiPin(offset_ms + json_event.time_ms, midi_device,
+                std::vector<unsigned char>(midi_message, midi_message + json_event.message_size), json_event.priority) );
+            play_reporting.total_validated++;
+        }
+    };
+    addPins(json_file.events, midi_devices, false);
+    if (rows_encoding)
+        addPins(json_file.rows_events, rows_devices, true);
+
+    for (const JsonRejectedItem &rejected_item : json_file.rejected_items) {
+        if (rejected_item.devices_index == rejected_rows_item && !rows_encoding)
+            continue;
+        if (rejected_item.devices_index == rejected_rows_item
+                || (rejected_item.devices_index < midi_devices.size() && midi_devices[rejected_item.devices_index] != nullptr))
+            play_reporting.total_incorrect++;
+        if (verbose) std::cerr << "Rejected item at byte " << rejected_item.byte_offset << ": " << rejected_item.reason << std::endl;
+    }
+}
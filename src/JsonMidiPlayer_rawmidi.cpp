@@ -0,0 +1,153 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#include "JsonMidiPlayer_rawmidi.hpp"
+
+#ifdef JSON_MIDI_PLAYER_RAWMIDI
+    #include <cerrno>
+    #include <alsa/asoundlib.h>
+#endif
+
+
+std::vector<RawMidiPort> getRawMidiPorts() {
+    std::vector<RawMidiPort> rawmidi_ports;
+#ifdef JSON_MIDI_PLAYER_RAWMIDI
+    snd_rawmidi_info_t *rawmidi_info;
+    snd_rawmidi_info_alloca(&rawmidi_info);
+    int card = -1;
+    while (snd_card_next(&card) == 0 && card >= 0) {
+        const std::string card_id = "hw:" + std::to_string(card);
+        snd_ctl_t *card_ctl;
+        if (snd_ctl_open(&card_ctl, card_id.c_str(), 0) < 0)
+            continue;
+        int device = -1;
+        while (snd_ctl_rawmidi_next_device(card_ctl, &device) == 0 && device >= 0) {
+            snd_rawmidi_info_set_device(rawmidi_info, device);
+            snd_rawmidi_info_set_stream(rawmidi_info, SND_RAWMIDI_STREAM_OUTPUT);
+            snd_rawmidi_info_set_subdevice(rawmidi_info, 0);
+            if (snd_ctl_rawmidi_info(card_ctl, rawmidi_info) < 0)
+                continue;   // An input only device
+            const unsigned int total_subdevices = snd_rawmidi_info_get_subdevices_count(rawmidi_info);
+            for (unsigned int subdevice = 0; subdevice < total_subdevices; ++subdevice) {
+                snd_rawmidi_info_set_subdevice(rawmidi_info, subdevice);
+                if (snd_ctl_rawmidi_info(card_ctl, rawmidi_info) < 0)
+                    continue;
+                const std::string hw_id = card_id + "," + std::to_string(device) + "," + std::to_string(subdevice);
+                const char *subdevice_name = snd_rawmidi_info_get_subdevice_name(rawmidi_info);
+                const std::string port_name = subdevice_name != nullptr && subdevice_name[0] != '\0'
+                    ? subdevice_name : snd_rawmidi_info_get_name(rawmidi_info);
+                rawmidi_ports.push_back({ RAWMIDI_PREFIX + port_name + " " + hw_id, hw_id });
+            }
+        }
+        snd_ctl_close(card_ctl);
+    }
+#endif
+    return rawmidi_ports;
+}
+
+
+RawMidiOut::RawMidiOut(const std::string &hw_id, bool running_status)
+    : hw_id(hw_id), running_status(running_status) { }
+
+RawMidiOut::~RawMidiOut() {
+    closePort();
+}
+
+const char *RawMidiOut::getNamePrefix() const {
+    return RAWMIDI_PREFIX;
+}
+
+void RawMidiOut::openPort() {
+#ifdef JSON_MIDI_PLAYER_RAWMIDI
+    if (rawmidi_handle != nullptr)
+        return;
+    // Non blocking, so that a busy port never holds the playing
+    int result = snd_rawmidi_open(nullptr, &rawmidi_handle, hw_id.c_str(), SND_RAWMIDI_NONBLOCK);
+    if (result < 0) {
+        rawmidi_handle = nullptr;
+        throw RtMidiError("RawMidiOut::openPort: error opening " + hw_id + ": " + snd_strerror(result),
+                            RtMidiError::DRIVER_ERROR);
+    }
+    last_status = 0;
+#else
+    throw RtMidiError("RawMidiOut::openPort: built without the rawmidi output", RtMidiError::INVALID_DEVICE);
+#endif
+}
+
+void RawMidiOut::closePort() {
+#ifdef JSON_MIDI_PLAYER_RAWMIDI
+    if (rawmidi_handle != nullptr) {
+        snd_rawmidi_nonblock(rawmidi_handle, 0);
+        flush();
+        snd_rawmidi_drain(rawmidi_handle);
+        snd_rawmidi_close(rawmidi_handle);
+        rawmidi_handle = nullptr;
+    }
+#endif
+    pending_bytes.clear();
+    written_bytes = 0;
+}
+
+void RawMidiOut::sendMessage(const unsigned char *midi_message, size_t message_size, double /*late_ms*/) {
+    if (message_size == 0)
+        return;
+    const unsigned char status_byte = midi_message[0];
+    size_t first_byte = 0;
+    if (status_byte < 0x80) {
+        // A SysEx chunk continuing the previous one, the running status was already cancelled by its F0
+    } else if (status_byte >= 0xF8) {
+        // Real-Time messages may go anywhere, even in between the running status ones
+    } else if (status_byte >= 0xF0) {
+        last_status = 0;    // SysEx and System Common cancel the running status
+    } else if (running_status && status_byte == last_status) {
+        first_byte = 1;
+    } else {
+        last_status = status_byte;
+    }
+    pending_bytes.insert(pending_bytes.end(), midi_message + first_byte, midi_message + message_size);
+}
+
+bool RawMidiOut::flush() {
+#ifdef JSON_MIDI_PLAYER_RAWMIDI
+    while (rawmidi_handle != nullptr && written_bytes < pending_bytes.size()) {
+        ssize_t written = snd_rawmidi_write(rawmidi_handle,
+            pending_bytes.data() + written_bytes, pending_bytes.size() - written_bytes);
+        if (written == -EAGAIN)
+            return false;   // The port buffer is full, the rest is written by the next flush
+        if (written < 0) {
+            // Like an unplugged interface, the bytes are lost and the next message sends its status again
+            last_status = 0;
+            break;
+        }
+        written_bytes += static_cast<size_t>(written);
+    }
+#endif
+    pending_bytes.clear();
+    written_bytes = 0;
+    return true;
+}
+
+bool RawMidiOut::isByteStream() const {
+    return true;
+}
+
+// Most hardware interfaces end on a DIN cable, even the USB ones
+double RawMidiOut::getByteTime() const {
+    return MIDI_DIN_BYTE_MS;
+}
+
+bool RawMidiOut::hasPendingBytes() const {
+    return written_bytes < pending_bytes.size();
+}
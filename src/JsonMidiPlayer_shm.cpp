@@ -0,0 +1,151 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#include "JsonMidiPlayer_shm.hpp"
+
+#include <new>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+
+static size_t shmRingSize(uint32_t capacity) {
+    return sizeof(ShmRingHeader) + static_cast<size_t>(capacity) * sizeof(ShmRingEvent);
+}
+
+ShmRingHeader *createShmRing(const char* shm_name, uint32_t capacity) {
+#ifdef _WIN32
+    std::cerr << "The shared memory ring needs POSIX shared memory, not available on Windows" << std::endl;
+    return nullptr;
+#else
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        std::cerr << "The shared memory ring capacity shall be a power of 2" << std::endl;
+        return nullptr;
+    }
+    int shm_fd = shm_open(shm_name, O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (shm_fd < 0) {
+        std::cerr << "Unable to open the shared memory " << shm_name << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    size_t ring_size = shmRingSize(capacity);
+    if (ftruncate(shm_fd, ring_size) != 0) {
+        std::cerr << "Unable to size the shared memory " << shm_name << ": " << std::strerror(errno) << std::endl;
+        close(shm_fd);
+        shm_unlink(shm_name);
+        return nullptr;
+    }
+    void *ring_memory = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    close(shm_fd);  // The mapping keeps it
+    if (ring_memory == MAP_FAILED) {
+        std::cerr << "Unable to map the shared memory " << shm_name << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(shm_name);
+        return nullptr;
+    }
+    std::memset(ring_memory, 0, ring_size);
+    ShmRingHeader *shm_ring = new (ring_memory) ShmRingHeader();
+    shm_ring->version = SHM_RING_VERSION;
+    shm_ring->capacity = capacity;
+    shm_ring->event_size = sizeof(ShmRingEvent);
+    shm_ring->closed.store(0);
+    shm_ring->write_index.store(0);
+    shm_ring->read_index.store(0);
+    shm_ring->timeline_ms.store(0.0);
+    // Written last, a producer only starts once it sees it
+    std::atomic_thread_fence(std::memory_order_release);
+    shm_ring->magic = SHM_RING_MAGIC;
+    return shm_ring;
+#endif
+}
+
+void destroyShmRing(const char* shm_name, ShmRingHeader *shm_ring) {
+#ifndef _WIN32
+    if (shm_ring == nullptr)
+        return;
+    munmap(shm_ring, shmRingSize(shm_ring->capacity));
+    shm_unlink(shm_name);
+#endif
+}
+
+
+// Resolved again only when its name changes, like in the json "devices" lists the first one opened is used
+static MidiDevice *getRingDevice(ShmRingHeader *shm_ring, uint8_t device_index,
+                                    MidiDeviceResolver &device_resolver, ShmRingDevices &ring_devices) {
+    if (device_index >= SHM_DEVICE_NAMES)
+        return nullptr;
+    const char *ring_name = shm_ring->device_names[device_index];
+    std::string device_name(ring_name, strnlen(ring_name, SHM_DEVICE_NAME_SIZE));
+    if (device_name != ring_devices.device_names[device_index]) {
+        ring_devices.device_names[device_index] = device_name;
+        ring_devices.device_ids[device_index] = no_device_id;
+        if (!device_name.empty())
+            ring_devices.device_ids[device_index] = device_resolver.connectName(device_resolver.getNameId(device_name));
+    }
+    return device_resolver.getDevice(ring_devices.device_ids[device_index]);
+}
+
+size_t takeShmEvents(ShmRingHeader *shm_ring, MidiDeviceResolver &device_resolver, ShmRingDevices &ring_devices,
+                        std::list<MidiPin> &midi_pins, PlayReporting &play_reporting) {
+    const uint64_t capacity = shm_ring->capacity;
+    uint64_t read_index = shm_ring->read_index.load(std::memory_order_relaxed);
+    const uint64_t write_index = shm_ring->write_index.load(std::memory_order_acquire);
+    if (write_index - read_index > capacity) {
+        play_reporting.total_incorrect += write_index - read_index - capacity;     // Overwritten by the producer
+        read_index = write_index - capacity;
+    }
+    const ShmRingEvent *ring_events = reinterpret_cast<const ShmRingEvent*>(
+        reinterpret_cast<const unsigned char*>(shm_ring) + sizeof(ShmRingHeader));
+    for (uint64_t event_index = read_index; event_index < write_index; ++event_index) {
+        const ShmRingEvent ring_event = ring_events[event_index & (capacity - 1)];
+        play_reporting.total_incorrect++;
+        if (!std::isfinite(ring_event.time_ms) || ring_event.time_ms < 0 || ring_event.size > SHM_MESSAGE_SIZE || !isValidMidiMessage(ring_event.message, ring_event.size))
+            continue;
+        MidiDevice *midi_device = getRingDevice(shm_ring, ring_event.device, device_resolver, ring_devices);
+        if (midi_device == nullptr)
+            continue;
+        std::vector<unsigned char> midi_message(ring_event.message, ring_event.message + ring_event.size);
+        unsigned char priority = getMessagePriority(midi_message);
+        if (priority == 0x00)
+            continue;
+        midi_pins.push_back( MidiPin(ring_event.time_ms, midi_device, midi_message, priority) );
+        play_reporting.total_incorrect--;    // Cancels out the initial ++ increase at the beginning of the loop
+        play_reporting.total_validated++;
+    }
+    // Only now the producer may write over the events taken
+    shm_ring->read_index.store(write_index, std::memory_order_release);
+    return write_index - read_index;
+}
+
+bool isShmRingDone(ShmRingHeader *shm_ring) {
+    return shm_ring->closed.load(std::memory_order_acquire) != 0
+        && shm_ring->read_index.load(std::memory_order_relaxed) == shm_ring->write_index.load(std::memory_order_acquire);
+}
+
+
+int PlayShmRing(const char* shm_name, bool verbose) {
+    ShmRingHeader *shm_ring = createShmRing(shm_name);
+    if (shm_ring == nullptr)
+        return EXIT_FAILURE;
+    if (verbose) std::cout << "Playing the events written in the shared memory: " << shm_name << std::endl;
+    PlayControl play_control;
+    play_control.shm_ring = shm_ring;
+    play_control.streaming_input.store(true);   // Until the producer closes the ring
+    int play_result = PlayList("[]", verbose, &play_control);
+    destroyShmRing(shm_name, shm_ring);
+    return play_result;
+}
@@ -0,0 +1,357 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+#include "JsonMidiPlayer_smf.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <queue>
+
+
+MidiEventsData SmfEvents::getEventsData() {
+    device_names_table.clear();
+    for (const std::string &device_name : device_names)
+        device_names_table.push_back(device_name.c_str());
+    return { events.data(), events.size(), device_names_table.data(), device_names_table.size(),
+                sysex_data.data(), sysex_data.size() };
+}
+
+std::vector<std::string> splitTrackDevices(const char* track_devices) {
+    std::vector<std::string> device_names;
+    std::stringstream devices_stream(track_devices);
+    std::string device_name;
+    while (std::getline(devices_stream, device_name, ','))
+        device_names.push_back(device_name);
+    return device_names;
+}
+
+bool isSmfData(const unsigned char* smf_data, size_t smf_size) {
+    return smf_size >= 14 && std::memcmp(smf_data, "MThd", 4) == 0;
+}
+
+
+static uint32_t readBigEndian(const unsigned char *bytes, size_t size) {
+    uint32_t value = 0;
+    for (size_t byte_i = 0; byte_i < size; ++byte_i)
+        value = (value << 8) | bytes[byte_i];
+    return value;
+}
+
+static bool readVariableLength(const unsigned char *&position, const unsigned char *end, uint32_t &value) {
+    value = 0;
+    for (int byte_i = 0; byte_i < 4 && position < end; ++byte_i) {
+        unsigned char variable_byte = *position++;
+        value = (value << 7) | (variable_byte & 0x7F);
+        if (!(variable_byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// A track chunk being read, with the tick of its next event
+struct SmfTrack {
+    const unsigned char *position;
+    const unsigned char *end;
+    uint64_t tick = 0;
+    unsigned char running_status = 0;
+    uint8_t device = 0;
+};
+
+// Reads the delta time of the next event, false at the end of the track
+static bool nextTrackEvent(SmfTrack &smf_track) {
+    uint32_t delta_ticks;
+    if (!readVariableLength(smf_track.position, smf_track.end, delta_ticks) || smf_track.position >= smf_track.end)
+        return false;
+    smf_track.tick += delta_ticks;
+    return true;
+}
+
+static bool getDeviceIndex(const std::string &device_name, SmfEvents &smf_events, uint8_t &device_index) {
+    for (size_t device_i = 0; device_i < smf_events.device_names.size(); ++device_i) {
+        if (smf_events.device_names[device_i] == device_name) {
+            device_index = static_cast<uint8_t>(device_i);
+            return true;
+        }
+    }
+    if (smf_events.device_names.size() > UINT8_MAX)
+        return false;
+    device_index = static_cast<uint8_t>(smf_events.device_names.size());
+    smf_events.device_names.push_back(device_name);
+    return true;
+}
+
+
+bool readSmfData(const unsigned char* smf_data, size_t smf_size, const std::vector<std::string> &track_devices,
+                    SmfEvents &smf_events, double offset_ms) {
+
+    if (!isSmfData(smf_data, smf_size) || readBigEndian(smf_data + 4, 4) < 6) {
+        std::cerr << "Not a Standard MIDI File" << std::endl;
+        return false;
+    }
+    const uint32_t header_size = readBigEndian(smf_data + 4, 4);
+    const uint32_t smf_format = readBigEndian(smf_data + 8, 2);
+    const uint32_t total_tracks = readBigEndian(smf_data + 10, 2);
+    const uint32_t division = readBigEndian(smf_data + 12, 2);
+    if (smf_format > 1) {
+        std::cerr << "Only the Standard MIDI File formats 0 and 1 are supported, not the format " << smf_format << std::endl;
+        return false;
+    }
+    if ((division & 0x7FFF) == 0 || (division & 0x8000 && (division & 0xFF) == 0)) {
+        std::cerr << "Standard MIDI File without a valid time division" << std::endl;
+        return false;
+    }
+
+    // The track chunks are read in place, a truncated file plays what it has
+    std::vector<SmfTrack> smf_tracks;
+    const unsigned char *smf_end = smf_data + smf_size;
+    const unsigned char *chunk = smf_data + std::min<size_t>(8 + static_cast<size_t>(header_size), smf_size);
+    while (smf_end - chunk >= 8 && smf_tracks.size() < total_tracks) {
+        const unsigned char *chunk_data = chunk + 8;
+        const size_t chunk_size = std::min<size_t>(readBigEndian(chunk + 4, 4), smf_end - chunk_data);
+        if (std::memcmp(chunk, "MTrk", 4) == 0) {    // Unknown chunks are skipped
+            SmfTrack smf_track;
+            smf_track.position = chunk_data;
+            smf_track.end = chunk_data + chunk_size;
+            const std::string device_name = track_devices.empty() ? "" :
+                track_devices[std::min(smf_tracks.size(), track_devices.size() - 1)];
+            if (!getDeviceIndex(device_name, smf_events, smf_track.device)) {
+                std::cerr << "Too many devices for the Standard MIDI File tracks" << std::endl;
+                return false;
+            }
+            smf_tracks.push_back(smf_track);
+        }
+        chunk = chunk_data + chunk_size;
+    }
+
+    // Ticks per quarter note follow the tempo map, while SMPTE ones have a fixed duration
+    const bool smpte_division = (division & 0x8000) != 0;
+    const uint64_t ticks_per_quarter = division & 0x7FFF;
+    double tick_ms = 0.0;
+    if (smpte_division) {
+        const int frames_per_second = -static_cast<int8_t>(division >> 8);
+        tick_ms = 1000.0 / ((frames_per_second == 29 ? 29.97 : frames_per_second) * (division & 0xFF));
+    }
+    // Time at the last tempo change, in microseconds times the ticks per quarter note, so it stays exact
+    uint64_t tempo_time = 0;
+    uint64_t tempo_tick = 0;
+    uint64_t tempo = SMF_DEFAULT_TEMPO;
+
+    // K-way merge of the tracks by tick, with the first track first at the same tick
+    using TrackTick = std::pair<uint64_t, size_t>;
+    std::priority_queue<TrackTick, std::vector<TrackTick>, std::greater<TrackTick>> next_events;
+    for (size_t track_i = 0; track_i < smf_tracks.size(); ++track_i) {
+        if (nextTrackEvent(smf_tracks[track_i]))
+            next_events.push({ smf_tracks[track_i].tick, track_i });
+    }
+
+    while (!next_events.empty()) {
+
+        const size_t track_i = next_events.top().second;
+        next_events.pop();
+        SmfTrack &smf_track = smf_tracks[track_i];
+        const unsigned char *&position = smf_track.position;
+
+        const double time_ms = offset_ms + (smpte_division ? smf_track.tick * tick_ms :
+            (tempo_time + (smf_track.tick - tempo_tick) * tempo) / (ticks_per_quarter * 1000.0));
+
+        unsigned char status_byte = *position;
+        if (status_byte & 0x80)
+            position++;
+        else if (smf_track.running_status != 0)
+            status_byte = smf_track.running_status;
+        else
+            continue;   // Data bytes without status, the rest of the track is dropped
+
+        if (status_byte < system_sysex_start) {
+
+            smf_track.running_status = status_byte;
+            const size_t data_bytes = (status_byte & 0xF0) == action_program_change
+                || (status_byte & 0xF0) == action_channel_pressure ? 1 : 2;
+            if (static_cast<size_t>(smf_track.end - position) < data_bytes)
+                continue;
+            MidiEventRecord midi_event = { time_ms, smf_track.device, status_byte, position[0],
+                static_cast<uint8_t>(data_bytes == 2 ? position[1] : 0), 0 };
+            // A Note On without velocity is a Note Off
+            if ((status_byte & 0xF0) == action_note_on && midi_event.data_byte_2 == 0)
+                midi_event.status_byte = action_note_off | (status_byte & 0x0F);
+            smf_events.events.push_back(midi_event);
+            position += data_bytes;
+
+        } else if (status_byte == smf_meta_event) {
+
+            smf_track.running_status = 0;
+            uint32_t meta_size;
+            if (position >= smf_track.end)
+                continue;
+            const unsigned char meta_type = *position++;
+            if (!readVariableLength(position, smf_track.end, meta_size) || meta_size > smf_track.end - position)
+                continue;
+            if (meta_type == smf_meta_end_of_track)
+                continue;
+            if (meta_type == smf_meta_set_tempo && meta_size == 3) {
+                tempo_time += (smf_track.tick - tempo_tick) * tempo;
+                tempo_tick = smf_track.tick;
+                tempo = readBigEndian(position, 3);
+            }
+            position += meta_size;
+
+        } else if (status_byte == system_sysex_start || status_byte == system_sysex_end) {
+
+            smf_track.running_status = 0;
+            uint32_t sysex_size;
+            if (!readVariableLength(position, smf_track.end, sysex_size) || sysex_size > smf_track.end - position)
+                continue;
+            // Only whole SysEx messages are played, not the ones split in packets
+            if (status_byte == system_sysex_start && sysex_size > 0 && position[sysex_size - 1] == system_sysex_end) {
+                smf_events.events.push_back({ time_ms, smf_track.device, system_sysex_start, 0, 0,
+                    static_cast<uint32_t>(smf_events.sysex_data.size()) });
+                smf_events.sysex_data.push_back(system_sysex_start);
+                smf_events.sysex_data.insert(smf_events.sysex_data.end(), position, position + sysex_size);
+            // Escaped bytes are played when they are a single system message, like the exported clocks
+            } else if (status_byte == system_sysex_end && sysex_size > 0 && sysex_size <= 3
+                    && position[0] > system_sysex_start && isValidMidiMessage(position, sysex_size)) {
+                smf_events.events.push_back({ time_ms, smf_track.device, position[0],
+                    static_cast<uint8_t>(sysex_size > 1 ? position[1] : 0), static_cast<uint8_t>(sysex_size > 2 ? position[2] : 0), 0 });
+            }
+            position += sysex_size;
+
+        } else
+            continue;   // Not valid in a file, the rest of the track is dropped
+
+        if (nextTrackEvent(smf_track))
+            next_events.push({ smf_track.tick, track_i });
+    }
+    return true;
+}
+
+bool readSmfFile(const char* filename, const std::vector<std::string> &track_devices,
+                    SmfEvents &smf_events, double offset_ms) {
+    std::ifstream smf_file(filename, std::ios::binary);
+    if (!smf_file.is_open()) {
+        std::cerr << "Could not open the file: " << filename << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> smf_data((std::istreambuf_iterator<char>(smf_file)), std::istreambuf_iterator<char>());
+    return readSmfData(smf_data.data(), smf_data.size(), track_devices, smf_events, offset_ms);
+}
+
+
+static void writeBigEndian(std::vector<unsigned char> &bytes, uint32_t value, size_t size) {
+    for (size_t byte_i = size; byte_i > 0; --byte_i)
+        bytes.push_back(static_cast<unsigned char>(value >> (8 * (byte_i - 1))));
+}
+
+static void writeVariableLength(std::vector<unsigned char> &bytes, uint32_t value) {
+    unsigned char variable_bytes[4];
+    size_t total_bytes = 0;
+    do {
+        variable_bytes[total_bytes++] = value & 0x7F;
+        value >>= 7;
+    } while (value > 0 && total_bytes < 4);
+    while (total_bytes > 1)
+        bytes.push_back(variable_bytes[--total_bytes] | 0x80);
+    bytes.push_back(variable_bytes[0]);
+}
+
+// A track chunk being written, with the tick of its last event
+struct SmfTrackWriter {
+    MidiDevice *midi_device = nullptr;
+    std::vector<unsigned char> track_data;
+    uint64_t tick = 0;
+    unsigned char running_status = 0;
+};
+
+static void writeDeltaTime(SmfTrackWriter &track_writer, uint64_t tick) {
+    const uint32_t maximum_delta = 0x0FFFFFFF;
+    uint64_t delta_ticks = tick > track_writer.tick ? tick - track_writer.tick : 0;
+    // Longer gaps are bridged with empty text events
+    while (delta_ticks > maximum_delta) {
+        writeVariableLength(track_writer.track_data, maximum_delta);
+        track_writer.track_data.insert(track_writer.track_data.end(), { smf_meta_event, smf_meta_text, 0x00 });
+        track_writer.running_status = 0;
+        delta_ticks -= maximum_delta;
+    }
+    writeVariableLength(track_writer.track_data, static_cast<uint32_t>(delta_ticks));
+    track_writer.tick = std::max(track_writer.tick, tick);
+}
+
+bool writeSmfFile(const char* filename, const std::list<MidiPin> &midi_pins) {
+
+    const double ticks_per_ms = SMF_EXPORT_TICKS_PER_QUARTER * 1000.0 / SMF_DEFAULT_TEMPO;
+    std::vector<SmfTrackWriter> track_writers(1);
+    std::vector<unsigned char> &tempo_track = track_writers[0].track_data;
+    tempo_track.insert(tempo_track.end(), { 0x00, smf_meta_event, smf_meta_set_tempo, 0x03 });
+    writeBigEndian(tempo_track, SMF_DEFAULT_TEMPO, 3);
+
+    for (const MidiPin &midi_pin : midi_pins) {
+
+        size_t track_i = 1;
+        while (track_i < track_writers.size() && track_writers[track_i].midi_device != midi_pin.getDevice())
+            ++track_i;
+        if (track_i == track_writers.size()) {
+            SmfTrackWriter track_writer;
+            track_writer.midi_device = midi_pin.getDevice();
+            const std::string &device_name = track_writer.midi_device->getName();
+            track_writer.track_data.insert(track_writer.track_data.end(), { 0x00, smf_meta_event, smf_meta_track_name });
+            writeVariableLength(track_writer.track_data, static_cast<uint32_t>(device_name.size()));
+            track_writer.track_data.insert(track_writer.track_data.end(), device_name.begin(), device_name.end());
+            track_writers.push_back(std::move(track_writer));
+        }
+        SmfTrackWriter &track_writer = track_writers[track_i];
+        std::vector<unsigned char> &track_data = track_writer.track_data;
+
+        writeDeltaTime(track_writer, std::llround(midi_pin.getTime() * ticks_per_ms));
+        const std::vector<unsigned char> midi_message = midi_pin.getMessage();
+        const unsigned char status_byte = midi_message[0];
+        if (status_byte < system_sysex_start) {
+            // Running status, the status byte is only written when it changes
+            if (status_byte != track_writer.running_status)
+                track_data.push_back(status_byte);
+            track_writer.running_status = status_byte;
+            track_data.insert(track_data.end(), midi_message.begin() + 1, midi_message.end());
+        } else {
+            if (status_byte == system_sysex_start) {
+                track_data.push_back(system_sysex_start);
+                writeVariableLength(track_data, static_cast<uint32_t>(midi_message.size() - 1));
+                track_data.insert(track_data.end(), midi_message.begin() + 1, midi_message.end());
+            } else {
+                track_data.push_back(system_sysex_end);
+                writeVariableLength(track_data, static_cast<uint32_t>(midi_message.size()));
+                track_data.insert(track_data.end(), midi_message.begin(), midi_message.end());
+            }
+            track_writer.running_status = 0;
+        }
+    }
+
+    std::vector<unsigned char> smf_data = { 'M', 'T', 'h', 'd' };
+    writeBigEndian(smf_data, 6, 4);
+    writeBigEndian(smf_data, 1, 2);
+    writeBigEndian(smf_data, static_cast<uint32_t>(track_writers.size()), 2);
+    writeBigEndian(smf_data, SMF_EXPORT_TICKS_PER_QUARTER, 2);
+    for (SmfTrackWriter &track_writer : track_writers) {
+        track_writer.track_data.insert(track_writer.track_data.end(), { 0x00, smf_meta_event, smf_meta_end_of_track, 0x00 });
+        smf_data.insert(smf_data.end(), { 'M', 'T', 'r', 'k' });
+        writeBigEndian(smf_data, static_cast<uint32_t>(track_writer.track_data.size()), 4);
+        smf_data.insert(smf_data.end(), track_writer.track_data.begin(), track_writer.track_data.end());
+    }
+
+    std::ofstream smf_file(filename, std::ios::binary);
+    if (!smf_file.is_open()) {
+        std::cerr << "Could not open the file: " << filename << std::endl;
+        return false;
+    }
+    smf_file.write(reinterpret_cast<const char*>(smf_data.data()), smf_data.size());
+    return smf_file.good();
+}
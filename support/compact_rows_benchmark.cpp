@@ -0,0 +1,117 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+// Compares the parsing and processing of the same notes given as midi_message objects and as compact rows,
+// both with the nlohmann json and with the schema parser
+//   Built with: cmake -DJSON_MIDI_PLAYER_BENCHMARKS=ON ..
+//   Run as: ./compact_rows_benchmark [total_notes] [repetitions]
+#include "JsonMidiPlayer.hpp"
+#include "JsonMidiPlayer_parser.hpp"
+
+static std::string objectsFile(const std::string &device_name, size_t total_notes) {
+    nlohmann::json content = nlohmann::json::array();
+    content.push_back({ { "devices", { device_name } } });
+    for (size_t note_i = 0; note_i < total_notes; ++note_i) {
+        double time_ms = note_i * 10.0;
+        unsigned char key_note = 36 + note_i % 48;
+        content.push_back({ { "time_ms", time_ms },
+            { "midi_message", { { "status_byte", 0x90 }, { "data_byte_1", key_note }, { "data_byte_2", 100 } } } });
+        content.push_back({ { "time_ms", time_ms + 5.0 },
+            { "midi_message", { { "status_byte", 0x80 }, { "data_byte_1", key_note }, { "data_byte_2", 0 } } } });
+    }
+    return nlohmann::json::array({ { { "filetype", FILE_TYPE }, { "url", FILE_URL }, { "content", content } } }).dump();
+}
+
+static std::string rowsFile(const std::string &device_name, size_t total_notes) {
+    nlohmann::json rows = nlohmann::json::array();
+    for (size_t note_i = 0; note_i < total_notes; ++note_i) {
+        double time_ms = note_i * 10.0;
+        unsigned char key_note = 36 + note_i % 48;
+        rows.push_back({ time_ms, 0x90, key_note, 100 });
+        rows.push_back({ time_ms + 5.0, 0x80, key_note, 0 });
+    }
+    nlohmann::json content = nlohmann::json::array({ { { "device", 0 }, { "rows", rows } } });
+    return nlohmann::json::array({ { { "filetype", FILE_TYPE }, { "url", FILE_URL }, { "encoding", "rows" },
+        { "devices", nlohmann::json::array({ { device_name } }) }, { "content", content } } }).dump();
+}
+
+// Best time out of the repetitions, in milliseconds, of the parsing and of the processing into pins
+static void benchmarkFile(const char* file_label, const std::string &json_str, bool schema_parser, size_t repetitions,
+                            MidiDeviceResolver &device_resolver) {
+    double parsing_ms = std::numeric_limits<double>::max();
+    double processing_ms = std::numeric_limits<double>::max();
+    size_t total_pins = 0;
+    for (size_t repetition_i = 0; repetition_i < repetitions; ++repetition_i) {
+        std::list<MidiPin> midi_pins;
+        PlayReporting play_reporting;
+        auto parsing_start = std::chrono::high_resolution_clock::now();
+        auto processing_start = parsing_start;
+        if (schema_parser) {
+            std::vector<JsonFile> json_files = readJsonFiles(
+                reinterpret_cast<const unsigned char*>(json_str.data()), json_str.size(), format_json);
+            processing_start = std::chrono::high_resolution_clock::now();
+            for (auto &json_file : json_files)
+                processJsonFile(json_file, device_resolver, midi_pins, play_reporting, false);
+        } else {
+            nlohmann::json json_files_data = nlohmann::json::parse(json_str);
+            processing_start = std::chrono::high_resolution_clock::now();
+            for (auto &file_data : json_files_data)
+                processJsonData(file_data, device_resolver, midi_pins, play_reporting, false);
+        }
+        auto processing_finish = std::chrono::high_resolution_clock::now();
+        parsing_ms = std::min(parsing_ms, std::chrono::duration<double, std::milli>(processing_start - parsing_start).count());
+        processing_ms = std::min(processing_ms, std::chrono::duration<double, std::milli>(processing_finish - processing_start).count());
+        total_pins = midi_pins.size();
+    }
+    std::cout << std::left << std::setw(10) << file_label << std::setw(10) << (schema_parser ? "schema" : "nlohmann")
+        << std::right << std::setw(12) << json_str.size()
+        << std::setw(12) << total_pins
+        << std::setw(14) << std::fixed << std::setprecision(3) << parsing_ms
+        << std::setw(14) << processing_ms << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+
+    const size_t total_notes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const size_t repetitions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+    // The pins need a device with its port opened
+    std::vector<MidiDevice> available_midi_devices;
+    try {
+        RtMidiOut midiOut;
+        for (unsigned int port_i = 0; port_i < midiOut.getPortCount(); port_i++)
+            available_midi_devices.push_back(MidiDevice(midiOut.getPortName(port_i), port_i, false));
+    } catch (RtMidiError &error) {
+        error.printMessage();
+        return EXIT_FAILURE;
+    }
+    if (available_midi_devices.size() == 0) {
+        std::cerr << "No output Midi devices available." << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string device_name = available_midi_devices[0].getName();
+    MidiDeviceResolver device_resolver(available_midi_devices);
+
+    std::cout << "Notes: " << total_notes << ", best of " << repetitions << " repetitions (ms)" << std::endl;
+    std::cout << std::left << std::setw(10) << "Encoding" << std::setw(10) << "Parser" << std::right << std::setw(12) << "Bytes"
+        << std::setw(12) << "Pins" << std::setw(14) << "Parsing" << std::setw(14) << "Processing" << std::endl;
+    const std::string objects_file = objectsFile(device_name, total_notes);
+    const std::string rows_file = rowsFile(device_name, total_notes);
+    benchmarkFile("objects", objects_file, false, repetitions, device_resolver);
+    benchmarkFile("objects", objects_file, true, repetitions, device_resolver);
+    benchmarkFile("rows", rows_file, false, repetitions, device_resolver);
+    benchmarkFile("rows", rows_file, true, repetitions, device_resolver);
+    return 0;
+}
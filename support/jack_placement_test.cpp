@@ -0,0 +1,147 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+// Checks that the JACK output places each message at the frame of its time, one period after it's sent,
+// by sending timed pins to a JACK midi input port registered here and reading the frames they arrive at
+// The dummy backend is enough, without any audio hardware: jackd -d dummy
+//   Built with: cmake -DJSON_MIDI_PLAYER_BENCHMARKS=ON ..
+//   Run as: ./jack_placement_test [total_pins] [interval_ms] [late_ms]
+#include "JsonMidiPlayer.hpp"
+#include "JsonMidiPlayer_jack.hpp"
+#include <jack/jack.h>
+#include <jack/midiport.h>
+
+#define PLACEMENT_TOLERANCE_FRAMES 1    // Rounding of the time conversions between the sending and the JACK thread
+
+struct ReceivedPin {
+    jack_nframes_t frame;           // Absolute frame time the message was placed at
+    jack_nframes_t period_offset;   // Its frame in the period, as given by jack_midi_event_get
+    unsigned char key_note;
+};
+
+struct PlacementInput {
+    jack_client_t *jack_client = nullptr;
+    jack_port_t *jack_port = nullptr;
+    std::vector<ReceivedPin> received_pins;     // Sized before activating, never allocated by the JACK thread
+    std::atomic<size_t> total_received{0};
+};
+
+// Runs on the JACK thread, after the JackMidiOut client given that it's connected to it
+static int processPlacementInput(jack_nframes_t total_frames, void *placement_input_data) {
+    PlacementInput *placement_input = static_cast<PlacementInput*>(placement_input_data);
+    void *port_buffer = jack_port_get_buffer(placement_input->jack_port, total_frames);
+    const jack_nframes_t cycle_start = jack_last_frame_time(placement_input->jack_client);
+    const uint32_t total_events = jack_midi_get_event_count(port_buffer);
+    size_t received_i = placement_input->total_received.load(std::memory_order_relaxed);
+    for (uint32_t event_i = 0; event_i < total_events; ++event_i) {
+        jack_midi_event_t midi_event;
+        if (jack_midi_event_get(&midi_event, port_buffer, event_i) != 0 || midi_event.size < 2)
+            continue;
+        if (received_i < placement_input->received_pins.size())
+            placement_input->received_pins[received_i++] = {
+                cycle_start + midi_event.time, midi_event.time, midi_event.buffer[1] };
+    }
+    placement_input->total_received.store(received_i, std::memory_order_release);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+    const size_t total_pins = std::max<size_t>(1, argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200);
+    const double interval_ms = argc > 2 ? std::atof(argv[2]) : 7.3;     // Not a divisor of the usual periods
+    const double late_ms = argc > 3 ? std::atof(argv[3]) : 2.5;         // Given to every other pin
+
+    PlacementInput placement_input;
+    placement_input.received_pins.resize(total_pins);
+    placement_input.jack_client = jack_client_open("jack_placement_test", JackNoStartServer, nullptr);
+    if (placement_input.jack_client == nullptr) {
+        std::cerr << "No JACK server running, started with jackd -d dummy ?" << std::endl;
+        return EXIT_FAILURE;
+    }
+    placement_input.jack_port = jack_port_register(placement_input.jack_client, "midi_in",
+                                                    JACK_DEFAULT_MIDI_TYPE, JackPortIsInput, 0);
+    if (placement_input.jack_port == nullptr
+            || jack_set_process_callback(placement_input.jack_client, processPlacementInput, &placement_input) != 0
+            || jack_activate(placement_input.jack_client) != 0) {
+        std::cerr << "Unable to register the JACK midi input port" << std::endl;
+        jack_client_close(placement_input.jack_client);
+        return EXIT_FAILURE;
+    }
+    const jack_nframes_t period_frames = jack_get_buffer_size(placement_input.jack_client);
+    std::cout << "Pins: " << total_pins << ", every " << interval_ms << " ms, " << late_ms << " ms late every other one, "
+              << "periods of " << period_frames << " frames at " << jack_get_sample_rate(placement_input.jack_client)
+              << " Hz" << std::endl;
+
+    // Frames the pin may be placed at, given by the JACK time right before and right after sending it
+    std::vector<std::pair<jack_nframes_t, jack_nframes_t>> expected_frames(total_pins);
+    int test_result = 0;
+    try {
+        JackMidiOut jack_midi_out(jack_port_name(placement_input.jack_port));
+        jack_midi_out.openPort();
+        auto sending_start = std::chrono::steady_clock::now();
+        for (size_t pin_i = 0; pin_i < total_pins; ++pin_i) {
+            std::this_thread::sleep_until(sending_start + std::chrono::microseconds(
+                static_cast<long long>(std::llround(pin_i * interval_ms * 1000.0))));
+            const double pin_late_ms = pin_i % 2 == 1 ? late_ms : 0.0;
+            const jack_time_t late_us = static_cast<jack_time_t>(std::llround(pin_late_ms * 1000.0));
+            const unsigned char midi_message[3] = { action_note_on, static_cast<unsigned char>(pin_i % 128), 100 };
+            const jack_time_t before_us = jack_get_time();
+            jack_midi_out.sendMessage(midi_message, sizeof(midi_message), pin_late_ms);
+            const jack_time_t after_us = jack_get_time();
+            expected_frames[pin_i] = {
+                jack_time_to_frames(placement_input.jack_client, before_us - late_us) + period_frames,
+                jack_time_to_frames(placement_input.jack_client, after_us - late_us) + period_frames
+            };
+        }
+        // Waits for the messages still to be placed, up to a second
+        for (int wait_i = 0; wait_i < 1000 && placement_input.total_received.load() < total_pins; ++wait_i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        jack_midi_out.closePort();
+    } catch (RtMidiError &error) {
+        error.printMessage();
+        test_result = EXIT_FAILURE;
+    }
+    jack_deactivate(placement_input.jack_client);
+
+    const size_t total_received = placement_input.total_received.load(std::memory_order_acquire);
+    size_t total_misplaced = 0;
+    size_t total_period_starts = 0;     // Placed at the frame 0 of a period, like without any placement
+    int32_t maximum_error = 0;
+    for (size_t pin_i = 0; pin_i < total_received; ++pin_i) {
+        const ReceivedPin &received_pin = placement_input.received_pins[pin_i];
+        // Frame times wrap around, so they are compared by their difference
+        const int32_t early_frames = static_cast<int32_t>(expected_frames[pin_i].first - received_pin.frame);
+        const int32_t late_frames = static_cast<int32_t>(received_pin.frame - expected_frames[pin_i].second);
+        const int32_t placement_error = std::max({ early_frames, late_frames, 0 });
+        maximum_error = std::max(maximum_error, placement_error);
+        if (placement_error > PLACEMENT_TOLERANCE_FRAMES || received_pin.key_note != pin_i % 128) {
+            total_misplaced++;
+            std::cerr << "Pin " << pin_i << " placed at the frame " << received_pin.frame << " instead of "
+                      << expected_frames[pin_i].first << " to " << expected_frames[pin_i].second << std::endl;
+        }
+        if (received_pin.period_offset == 0)
+            total_period_starts++;
+    }
+    jack_client_close(placement_input.jack_client);
+
+    std::cout << std::left << std::setw(24) << "Received pins" << std::right << std::setw(12) << total_received << std::endl;
+    std::cout << std::left << std::setw(24) << "Misplaced pins" << std::right << std::setw(12) << total_misplaced << std::endl;
+    std::cout << std::left << std::setw(24) << "At a period start" << std::right << std::setw(12) << total_period_starts << std::endl;
+    std::cout << std::left << std::setw(24) << "Maximum error (frames)" << std::right << std::setw(12) << maximum_error << std::endl;
+    if (total_received < total_pins || total_misplaced > 0)
+        test_result = EXIT_FAILURE;
+    std::cout << (test_result == 0 ? "PASSED" : "FAILED") << std::endl;
+    return test_result;
+}
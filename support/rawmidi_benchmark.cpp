@@ -0,0 +1,117 @@
+/*
+JsonMidiPlayer - Json Midi Player is intended to be used
+in conjugation with the Json Midi Creator to Play its composed Elements
+Original Copyright (c) 2024 Rui Seixas Monteiro. All right reserved.
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Lesser General Public License for more details.
+https://github.com/ruiseixasm/JsonMidiCreator
+https://github.com/ruiseixasm/JsonMidiPlayer
+*/
+// Compares the same midi messages sent through the ALSA sequencer, like by RtMidiOut, with the ones written
+// as raw bytes to the rawmidi device, each message on its own and together by time with running status
+// A virtual rawmidi card is enough, given by its sequencer and rawmidi ports: sudo modprobe snd-virmidi
+//   Built with: cmake -DJSON_MIDI_PLAYER_BENCHMARKS=ON -DJSON_MIDI_PLAYER_RAWMIDI=ON ..
+//   Run as: ./rawmidi_benchmark [total_messages] [messages_per_time] [device_name]
+#include "JsonMidiPlayer.hpp"
+#include "JsonMidiPlayer_rawmidi.hpp"
+
+// Chords played and released with Note On messages, with a Control Change after each one breaking the running status
+static std::vector<std::vector<unsigned char>> benchmarkMessages(size_t total_messages, size_t messages_per_time) {
+    std::vector<std::vector<unsigned char>> midi_messages;
+    for (size_t message_i = 0; message_i < total_messages; ++message_i) {
+        const size_t time_i = message_i / messages_per_time;
+        if (message_i % messages_per_time == messages_per_time - 1) {
+            midi_messages.push_back({ action_control_change, 1, static_cast<unsigned char>(time_i % 128) });
+        } else {
+            unsigned char key_note = 36 + message_i % messages_per_time;
+            midi_messages.push_back({ action_note_on, key_note, static_cast<unsigned char>(time_i % 2 == 0 ? 100 : 0) });
+        }
+    }
+    return midi_messages;
+}
+
+static void printResult(const char* path_label, size_t total_messages, double total_ms) {
+    std::cout << std::left << std::setw(24) << path_label << std::right
+        << std::setw(12) << total_messages
+        << std::setw(14) << std::fixed << std::setprecision(3) << total_ms
+        << std::setw(14) << total_ms * 1000.0 / total_messages << std::endl;
+}
+
+static double rawMidiMilliseconds(const std::string &hw_id, const std::vector<std::vector<unsigned char>> &midi_messages,
+                                    size_t messages_per_time, bool running_status) {
+    RawMidiOut rawmidi_out(hw_id, running_status);
+    rawmidi_out.openPort();
+    auto writing_start = std::chrono::high_resolution_clock::now();
+    for (size_t message_i = 0; message_i < midi_messages.size(); ++message_i) {
+        rawmidi_out.sendMessage(midi_messages[message_i].data(), midi_messages[message_i].size());
+        if ((message_i + 1) % messages_per_time == 0 || message_i + 1 == midi_messages.size()) {
+            while (!rawmidi_out.flush()) { }    // Waits for the port like the sequencer does
+        }
+    }
+    auto writing_finish = std::chrono::high_resolution_clock::now();
+    rawmidi_out.closePort();
+    return std::chrono::duration<double, std::milli>(writing_finish - writing_start).count();
+}
+
+int main(int argc, char *argv[]) {
+
+    const size_t total_messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const size_t messages_per_time = std::max<size_t>(1, argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4);
+    const std::string device_name = argc > 3 ? argv[3] : "Virtual Raw MIDI";
+
+    std::string rawmidi_hw_id;
+    for (const RawMidiPort &rawmidi_port : getRawMidiPorts()) {
+        if (rawmidi_port.name.find(device_name) != std::string::npos) {
+            rawmidi_hw_id = rawmidi_port.hw_id;
+            break;
+        }
+    }
+    if (rawmidi_hw_id.empty()) {
+        std::cerr << "No rawmidi device \"" << device_name << "\", built with -DJSON_MIDI_PLAYER_RAWMIDI=ON "
+                  << "and after sudo modprobe snd-virmidi ?" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<std::vector<unsigned char>> midi_messages = benchmarkMessages(total_messages, messages_per_time);
+    std::cout << "Messages: " << total_messages << ", " << messages_per_time << " per time, on " << rawmidi_hw_id << std::endl;
+    std::cout << std::left << std::setw(24) << "Path" << std::right << std::setw(12) << "Messages"
+        << std::setw(14) << "Total (ms)" << std::setw(14) << "Each (us)" << std::endl;
+
+    try {
+        RtMidiOut midiOut;
+        unsigned int sequencer_port = midiOut.getPortCount();
+        for (unsigned int port_i = 0; port_i < midiOut.getPortCount(); port_i++) {
+            if (midiOut.getPortName(port_i).find(device_name) != std::string::npos) {
+                sequencer_port = port_i;
+                break;
+            }
+        }
+        if (sequencer_port < midiOut.getPortCount()) {
+            midiOut.openPort(sequencer_port);
+            auto sending_start = std::chrono::high_resolution_clock::now();
+            for (const auto &midi_message : midi_messages)
+                midiOut.sendMessage(&midi_message);
+            auto sending_finish = std::chrono::high_resolution_clock::now();
+            midiOut.closePort();
+            printResult("sequencer", total_messages,
+                std::chrono::duration<double, std::milli>(sending_finish - sending_start).count());
+        } else {
+            std::cerr << "No sequencer port \"" << device_name << "\"" << std::endl;
+        }
+        printResult("rawmidi each message", total_messages, rawMidiMilliseconds(rawmidi_hw_id, midi_messages, 1, false));
+        printResult("rawmidi by time", total_messages,
+            rawMidiMilliseconds(rawmidi_hw_id, midi_messages, messages_per_time, false));
+        printResult("rawmidi running status", total_messages,
+            rawMidiMilliseconds(rawmidi_hw_id, midi_messages, messages_per_time, true));
+    } catch (RtMidiError &error) {
+        error.printMessage();
+        return EXIT_FAILURE;
+    }
+    return 0;
+}